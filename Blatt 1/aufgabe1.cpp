@@ -1,11 +1,29 @@
 // Implementation of Kruskal algorithm
-// Requires c++11 standard for compiling
+// Requires c++11 standard and -pthread for compiling. The modules shared with
+// the other exercises are compiled into this file and are found with the
+// include path ../common:
+//   g++ -std=c++11 -O3 -pthread -I ../common aufgabe1.cpp
 
 #include <iostream>
 #include <vector>
 #include <string>
 #include <fstream>
 #include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <functional>
+#include <deque>
+#include <stdexcept>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdlib>
+#include <unistd.h>
+#include "Writer.cpp"
+#include "Trace.cpp"
 
 // Data for a union find tree element
 class UnionFindData {
@@ -30,38 +48,184 @@ private:
   std::vector<UnionFindData> elements;
 };
 
-// Class for an edge
+// The edges of a graph as read from an input file. The graph is built from it
+// once the needed cost types are known.
+class Instance {
+public:
+  Instance(std::string filename, unsigned int threadCount = 1);
+  unsigned int getNodeCount();
+  unsigned int getEdgeCount();
+  unsigned int getA(unsigned int e);
+  unsigned int getB(unsigned int e);
+  long long int getCost(unsigned int e);
+  long long int getMaxCost();
+private:
+  unsigned int nodeCount;
+  std::vector<unsigned int> as;
+  std::vector<unsigned int> bs;
+  std::vector<long long int> costs;
+};
+
+// Class for an edge with a cost of type Cost
+template <typename Cost>
 class Edge {
 public:
-  Edge(unsigned int a, unsigned int b, int cost);
-  unsigned int getA();
-  unsigned int getB();
-  int getCost();
+  Edge(unsigned int a, unsigned int b, Cost cost);
+  unsigned int getA() const;
+  unsigned int getB() const;
+  Cost getCost() const;
 private:
   unsigned int a;
   unsigned int b;
-  int cost;
+  Cost cost;
+};
+
+// Maximum edge costs on the paths of a forest, computed with binary lifting:
+// up[j][a] is the ancestor 2^j levels above a and maxCost[j][a] the largest
+// cost on the path to it
+template <typename Cost>
+class PathMaxima {
+public:
+  PathMaxima(unsigned int nodeCount, const std::vector<Edge<Cost>>& edges);
+  bool maxOnPath(unsigned int a, unsigned int b, Cost& res);
+  bool exceedsPath(unsigned int a, unsigned int b, Cost cost);
+private:
+  std::vector<unsigned int> component;
+  // largest cost in the tree of every root
+  std::vector<Cost> componentMax;
+  std::vector<unsigned int> depth;
+  std::vector<std::vector<unsigned int>> up;
+  std::vector<std::vector<Cost>> maxCost;
+};
+
+// A connected component of a spanning forest: its nodes (in increasing
+// order) and the edges of its tree. Node ids are the ids of the whole graph.
+template <typename Cost, typename Weight>
+class Component {
+public:
+  Component();
+  void addNode(unsigned int a);
+  void addEdge(Edge<Cost> e);
+  unsigned int getNodeCount();
+  unsigned int getEdgeCount();
+  Weight getWeight();
+  const std::vector<unsigned int>& getNodes();
+  void exportBinary(std::ostream& out);
+  template <typename C, typename W>
+  friend std::ostream& operator<<(std::ostream& out, const Component<C, W>& o);
+private:
+  std::vector<unsigned int> nodes;
+  std::vector<Edge<Cost>> edges;
+  Weight weight;
+};
+
+// Answers bottleneck queries between two nodes (the smallest possible largest
+// edge cost on a path between them) in constant time, built from a minimum
+// spanning forest in kruskal order.
+//
+// The leaves of the Kruskal reconstruction tree, which has an inner node with
+// the cost of every forest edge above the two trees it joins, are ordered like
+// a depth first search would visit them. The bottleneck of two nodes is the
+// cost of their lowest common ancestor, which is the largest LCA cost of the
+// neighbouring leaves between them. The order is built by concatenating leaf
+// lists while replaying the union find merges, and a sparse table answers the
+// range maximum queries.
+template <typename Cost>
+class BottleneckIndex {
+public:
+  BottleneckIndex(unsigned int nodeCount, const std::vector<Edge<Cost>>& forest);
+  bool bottleneck(unsigned int a, unsigned int b, Cost& res);
+private:
+  std::vector<unsigned int> position;
+  std::vector<unsigned int> component;
+  // table[j][i] is the largest LCA cost of the neighbours at the positions
+  // i, ..., i+2^j-1 and their successors
+  std::vector<std::vector<Cost>> table;
 };
 
-// Class for a graph
+// Class for a graph with edge costs of type Cost, the total weight is of type
+// Weight
+template <typename Cost, typename Weight>
 class Graph {
 public:
+  typedef Cost CostType;
+  typedef Weight WeightType;
+  typedef Component<Cost, Weight> ComponentType;
+
   Graph();
   Graph(unsigned int nodeCount);
-  Graph(std::string filename);
-  void addEdge(unsigned int a, unsigned int b, int cost);
-  void addEdge(Edge e);
+  Graph(Instance& instance);
+  void addEdge(unsigned int a, unsigned int b, Cost cost);
+  void addEdge(Edge<Cost> e);
   unsigned int getNodeCount();
   void initGraph(unsigned int nc);
   unsigned int getEdgeCount();
-  long long int getWeight();
+  Weight getWeight();
   void sortEdges();
-  void kruskal(Graph& res);
-  friend std::ostream& operator<<(std::ostream& out, const Graph& o);
+  const std::vector<Edge<Cost>>& getEdges();
+  void kruskal(Graph& res, std::vector<Component<Cost, Weight>>* components = nullptr, unsigned int componentCount = 1);
+  void sparseKruskal(Graph& res, unsigned int k, std::vector<Component<Cost, Weight>>* components = nullptr,
+    unsigned int componentCount = 1);
+  void exportBinary(std::ostream& out);
+  template <typename C, typename W>
+  friend std::ostream& operator<<(std::ostream& out, const Graph<C, W>& o);
 private:
   unsigned int nodeCount;
-  std::vector<Edge> edges;
-  long long int weight;
+  std::vector<Edge<Cost>> edges;
+  Weight weight;
+};
+
+// Edges of an input file in sorted blocks, for solving while the file is
+// read. The file is parsed in blocks of blockSize edges, every full block is
+// sorted by cost on its own thread while parsing goes on (at most threadCount
+// blocks at the same time). kruskal merges the blocks.
+class SortedBlocks {
+public:
+  SortedBlocks(std::string filename, unsigned int threadCount, std::size_t blockSize = 1 << 16);
+  unsigned int getNodeCount();
+  unsigned int getEdgeCount();
+  long long int getMaxCost();
+  const std::deque<std::vector<Edge<long long int>>>& getBlocks();
+  template <typename Cost, typename Weight>
+  void kruskal(Graph<Cost, Weight>& res, std::vector<Component<Cost, Weight>>* components = nullptr,
+    unsigned int componentCount = 1);
+private:
+  unsigned int nodeCount;
+  unsigned int edgeCount = 0;
+  long long int maxCost = 0;
+  // a deque, so that the blocks being sorted do not move
+  std::deque<std::vector<Edge<long long int>>> blocks;
+};
+
+// Certificate check of a minimum spanning forest, which needs no second
+// solve: the forest has no cycle, its edges are edges of the graph and every
+// other edge of the graph costs at least the maximum on the forest path
+// between its nodes (cycle property). Edges between different trees are
+// only allowed for a single linkage clustering with clusterCount > 1
+// clusters, they have to cost at least every forest edge. Every edge of the
+// graph is given to check, finish prints the result.
+template <typename Cost, typename Weight>
+class ForestVerifier {
+public:
+  ForestVerifier(Graph<Cost, Weight>& forest, unsigned int clusterCount);
+  void check(unsigned int a, unsigned int b, Cost cost);
+  bool finish();
+private:
+  void fail(std::string reason);
+
+  unsigned int nodeCount;
+  unsigned int clusterCount;
+  unsigned int treeCount;
+  Cost maxForestCost;
+  bool betweenTrees = false;
+  bool valid = true;
+  std::string error;
+  PathMaxima<Cost> paths;
+  // index of every forest edge by its nodes and whether it was found in the
+  // graph
+  std::unordered_map<unsigned long long int, unsigned int> forestEdges;
+  std::vector<Cost> forestCosts;
+  std::vector<bool> found;
 };
 
 UnionFindData::UnionFindData(unsigned int pr) {
@@ -122,8 +286,170 @@ void UnionFind::un(unsigned int a, unsigned int b) {
   }
 }
 
+// Files below this size per thread are not split
+const std::size_t minChunkSize = 1 << 20;
+
+// The edges of one chunk of an input file
+struct EdgeChunk {
+  std::vector<unsigned int> as;
+  std::vector<unsigned int> bs;
+  std::vector<long long int> costs;
+  // false if parsing stopped before the end of the chunk
+  bool complete = false;
+};
+
+// Skips whitespace and reads a (possibly negative) number at p, returns false
+// if there is none
+bool readNumber(const char*& p, const char* end, long long int& value) {
+  while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+    p++;
+  }
+  bool negative = p < end && *p == '-';
+  if (negative) {
+    p++;
+  }
+  if (p == end || *p < '0' || *p > '9') {
+    return false;
+  }
+  value = 0;
+  while (p < end && *p >= '0' && *p <= '9') {
+    value = value*10 + (*p - '0');
+    p++;
+  }
+  if (negative) {
+    value = -value;
+  }
+  return true;
+}
+
+// Parses the edge lines between begin and end
+void parseChunk(const char* begin, const char* end, EdgeChunk& chunk) {
+  long long int a, b, cost;
+  while (readNumber(begin, end, a) && readNumber(begin, end, b) && readNumber(begin, end, cost)) {
+    chunk.as.push_back(a);
+    chunk.bs.push_back(b);
+    chunk.costs.push_back(cost);
+  }
+  chunk.complete = begin == end;
+}
+
+// Copies the edges of a chunk to their position in the instance arrays
+void copyChunk(const EdgeChunk& chunk, unsigned int* as, unsigned int* bs, long long int* costs) {
+  std::copy(chunk.as.begin(), chunk.as.end(), as);
+  std::copy(chunk.bs.begin(), chunk.bs.end(), bs);
+  std::copy(chunk.costs.begin(), chunk.costs.end(), costs);
+}
+
+// Parses a graph file. The edge lines are split into up to threadCount chunks
+// at line ends, which are parsed in parallel and concatenated in file order.
+// Like a stream, parsing stops at the first malformed edge.
+Instance::Instance(std::string filename, unsigned int threadCount) {
+  std::fstream file(filename, std::ios_base::in | std::ios_base::binary);
+
+  // Check if file is open
+  if (!file.is_open()) {
+    nodeCount = 0;
+    std::cout << "Input file does not exist." << '\n';
+    return;
+  }
+
+  file.seekg(0, std::ios_base::end);
+  std::string text(static_cast<std::size_t>(file.tellg()), '\0');
+  file.seekg(0, std::ios_base::beg);
+  file.read(&text[0], text.size());
+
+  const char* p = text.data();
+  const char* end = p + text.size();
+  long long int n = 0;
+  readNumber(p, end, n);
+  nodeCount = n;
+
+  // Chunk borders are moved behind the next line end
+  std::size_t size = end - p;
+  unsigned int chunkCount = std::max(1u, std::min(threadCount, static_cast<unsigned int>(size / minChunkSize)));
+  std::vector<const char*> borders(chunkCount + 1, end);
+  borders[0] = p;
+  for (unsigned int i = 1; i < chunkCount; i++) {
+    const char* border = std::max(borders[i-1], p + size / chunkCount * i);
+    border = std::find(border, end, '\n');
+    borders[i] = border == end ? end : border + 1;
+  }
+
+  std::vector<EdgeChunk> chunks(chunkCount);
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < chunkCount; i++) {
+    threads.push_back(std::thread(parseChunk, borders[i], borders[i+1], std::ref(chunks[i])));
+  }
+  parseChunk(borders[0], borders[1], chunks[0]);
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  // Only the chunks up to the first incomplete one are used
+  std::vector<unsigned int> offsets(1, 0);
+  for (unsigned int i = 0; i < chunkCount; i++) {
+    offsets.push_back(offsets.back() + chunks[i].costs.size());
+    if (!chunks[i].complete) {
+      chunkCount = i + 1;
+      break;
+    }
+  }
+
+  as.resize(offsets.back());
+  bs.resize(offsets.back());
+  costs.resize(offsets.back());
+  threads.clear();
+  for (unsigned int i = 1; i < chunkCount; i++) {
+    threads.push_back(std::thread(copyChunk, std::cref(chunks[i]), as.data() + offsets[i], bs.data() + offsets[i],
+      costs.data() + offsets[i]));
+  }
+  copyChunk(chunks[0], as.data(), bs.data(), costs.data());
+  for (std::thread& t : threads) {
+    t.join();
+  }
+}
+
+// Returns the node count of the instance
+unsigned int Instance::getNodeCount() {
+  return nodeCount;
+}
+
+// Returns the edge count of the instance
+unsigned int Instance::getEdgeCount() {
+  return costs.size();
+}
+
+// Returns the first node of an edge
+unsigned int Instance::getA(unsigned int e) {
+  return as[e];
+}
+
+// Returns the second node of an edge
+unsigned int Instance::getB(unsigned int e) {
+  return bs[e];
+}
+
+// Returns the cost of an edge
+long long int Instance::getCost(unsigned int e) {
+  return costs[e];
+}
+
+// Returns the largest absolute value of an edge cost
+long long int Instance::getMaxCost() {
+  long long int res = 0;
+  for (long long int c : costs) {
+    if (c > res) {
+      res = c;
+    } else if (-c > res) {
+      res = -c;
+    }
+  }
+  return res;
+}
+
 // Constuctor, initializes the edge
-Edge::Edge(unsigned int pa, unsigned int pb, int c) {
+template <typename Cost>
+Edge<Cost>::Edge(unsigned int pa, unsigned int pb, Cost c) {
   // a should be smaller than be
   if (pa <= pb) {
     a = pa;
@@ -137,61 +463,53 @@ Edge::Edge(unsigned int pa, unsigned int pb, int c) {
 }
 
 // Returns the first connected node
-unsigned int Edge::getA() {
+template <typename Cost>
+unsigned int Edge<Cost>::getA() const {
   return a;
 }
 
 // Returns the second connected node
-unsigned int Edge::getB() {
+template <typename Cost>
+unsigned int Edge<Cost>::getB() const {
   return b;
 }
 
 // Returns the cost of the edge
-int Edge::getCost() {
+template <typename Cost>
+Cost Edge<Cost>::getCost() const {
   return cost;
 }
 
-Graph::Graph() {
+template <typename Cost, typename Weight>
+Graph<Cost, Weight>::Graph() {
   nodeCount = 0;
   weight = 0;
 }
 
 // Constructor, initializes the graph
-Graph::Graph(unsigned int nc) {
+template <typename Cost, typename Weight>
+Graph<Cost, Weight>::Graph(unsigned int nc) {
   nodeCount = nc;
   weight = 0;
 }
 
-// Parses a graph file and constructs the graph
-Graph::Graph(std::string filename) {
-  std::fstream file(filename, std::ios_base::in);
-
-  // Check if file is open
-  if (!file.is_open()) {
-    nodeCount = 0;
-    weight = 0;
-    std::cout << "Input file does not exist." << '\n';
-    return;
-  }
-
-  // Set Node Count of the Graph
-  unsigned int nc;
-  file >> nc;
-  nodeCount = nc;
-
+// Constructs the graph of an instance, the costs have to fit into Cost
+template <typename Cost, typename Weight>
+Graph<Cost, Weight>::Graph(Instance& instance) {
+  nodeCount = instance.getNodeCount();
   weight = 0;
 
-  // Parses edges from the file
-  unsigned int a, b, cost;
-  while (file >> a >> b >> cost) {
-    addEdge(a, b, cost);
+  edges.reserve(instance.getEdgeCount());
+  for (unsigned int e = 0; e < instance.getEdgeCount(); e++) {
+    addEdge(instance.getA(e), instance.getB(e), static_cast<Cost>(instance.getCost(e)));
   }
 }
 
 // Adds an edge to the graph
-void Graph::addEdge(unsigned int a, unsigned int b, int cost) {
+template <typename Cost, typename Weight>
+void Graph<Cost, Weight>::addEdge(unsigned int a, unsigned int b, Cost cost) {
   if (a < getNodeCount() && b < getNodeCount()) {
-    Edge e(a, b, cost);
+    Edge<Cost> e(a, b, cost);
     edges.push_back(e);
     weight += cost;
   } else {
@@ -200,7 +518,8 @@ void Graph::addEdge(unsigned int a, unsigned int b, int cost) {
 }
 
 // Adds an edge to the graph
-void Graph::addEdge(Edge e) {
+template <typename Cost, typename Weight>
+void Graph<Cost, Weight>::addEdge(Edge<Cost> e) {
   if (e.getA() < getNodeCount() && e.getB() < getNodeCount()) {
     edges.push_back(e);
     weight += e.getCost();
@@ -210,12 +529,14 @@ void Graph::addEdge(Edge e) {
 }
 
 // Returns the node count of the graph
-unsigned int Graph::getNodeCount() {
+template <typename Cost, typename Weight>
+unsigned int Graph<Cost, Weight>::getNodeCount() {
   return nodeCount;
 }
 
 // Sets the node Count if the graph is empty
-void Graph::initGraph(unsigned int nc) {
+template <typename Cost, typename Weight>
+void Graph<Cost, Weight>::initGraph(unsigned int nc) {
   if (getNodeCount() == 0) {
     nodeCount = nc;
   } else {
@@ -224,92 +545,986 @@ void Graph::initGraph(unsigned int nc) {
 }
 
 // Returns the edge count of the graph
-unsigned int Graph::getEdgeCount() {
+template <typename Cost, typename Weight>
+unsigned int Graph<Cost, Weight>::getEdgeCount() {
   return edges.size();
 }
 
 // Returns the sum of all edge cost values
-long long int Graph::getWeight() {
+template <typename Cost, typename Weight>
+Weight Graph<Cost, Weight>::getWeight() {
   return weight;
 }
 
 // Compares the cost values of two edges
-bool cmp(Edge a, Edge b) {
+template <typename Cost>
+bool cmp(Edge<Cost> a, Edge<Cost> b) {
   return a.getCost() < b.getCost();
 }
 
 // sorts the edges of the graph by cost
-void Graph::sortEdges() {
-  std::sort(edges.begin(), edges.end(), cmp);
+template <typename Cost, typename Weight>
+void Graph<Cost, Weight>::sortEdges() {
+  std::sort(edges.begin(), edges.end(), cmp<Cost>);
 }
 
-// custom output for graphs (for printing)
-std::ostream& operator<<(std::ostream& out, const Graph& o) {
-  out << "Node count: " << o.nodeCount << "\n";
-  out << "Weight: " << o.weight << "\n";
-  for (Edge e : o.edges) {
-    out << "{" << e.getA() << ", " << e.getB() << "}\t with cost \t" << e.getCost() << "\n";
+// Writes the node count, the weight and the edges of a graph (for printing)
+template <typename Cost>
+void writeGraph(std::ostream& out, unsigned int nodeCount, long long int weight, const std::vector<Edge<Cost>>& edges) {
+  Writer w(out);
+  w.writeString("Node count: ");
+  w.writeUInt(nodeCount);
+  w.writeString("\nWeight: ");
+  w.writeInt(weight);
+  w.writeChar('\n');
+  for (const Edge<Cost>& e : edges) {
+    w.writeChar('{');
+    w.writeUInt(e.getA());
+    w.writeString(", ");
+    w.writeUInt(e.getB());
+    w.writeString("}\t with cost \t");
+    w.writeInt(e.getCost());
+    w.writeChar('\n');
+  }
+}
+
+// binary output of a graph (little endian): "EDMTREE1", the node count
+// (32 bit), the weight (64 bit, two's complement), the edge count k (32 bit)
+// and k triples of the nodes and the cost of an edge (32 bit each). Graphs
+// with 64 bit costs use "EDMTREE2" and write the costs with 64 bits.
+template <typename Cost>
+void writeGraphBinary(std::ostream& out, unsigned int nodeCount, long long int weight, const std::vector<Edge<Cost>>& edges) {
+  bool wide = sizeof(Cost) > 4;
+  Writer w(out);
+  w.writeBytes(wide ? "EDMTREE2" : "EDMTREE1", 8);
+  w.writeUInt32(nodeCount);
+  w.writeUInt64(static_cast<std::uint64_t>(weight));
+  w.writeUInt32(edges.size());
+  for (const Edge<Cost>& e : edges) {
+    w.writeUInt32(e.getA());
+    w.writeUInt32(e.getB());
+    if (wide) {
+      w.writeUInt64(static_cast<std::uint64_t>(e.getCost()));
+    } else {
+      w.writeUInt32(static_cast<std::uint32_t>(e.getCost()));
+    }
   }
+}
+
+// custom output for graphs (for printing)
+template <typename Cost, typename Weight>
+std::ostream& operator<<(std::ostream& out, const Graph<Cost, Weight>& o) {
+  writeGraph(out, o.nodeCount, o.weight, o.edges);
   return out;
 }
 
+// binary output of the graph, see writeGraphBinary
+template <typename Cost, typename Weight>
+void Graph<Cost, Weight>::exportBinary(std::ostream& out) {
+  writeGraphBinary(out, nodeCount, weight, edges);
+}
+
+template <typename Cost, typename Weight>
+Component<Cost, Weight>::Component() {
+  weight = 0;
+}
+
+// Adds a node to the component
+template <typename Cost, typename Weight>
+void Component<Cost, Weight>::addNode(unsigned int a) {
+  nodes.push_back(a);
+}
+
+// Adds an edge of the tree to the component
+template <typename Cost, typename Weight>
+void Component<Cost, Weight>::addEdge(Edge<Cost> e) {
+  edges.push_back(e);
+  weight += e.getCost();
+}
+
+// Returns the number of nodes of the component
+template <typename Cost, typename Weight>
+unsigned int Component<Cost, Weight>::getNodeCount() {
+  return nodes.size();
+}
+
+// Returns the number of tree edges of the component
+template <typename Cost, typename Weight>
+unsigned int Component<Cost, Weight>::getEdgeCount() {
+  return edges.size();
+}
+
+// Returns the weight of the tree of the component
+template <typename Cost, typename Weight>
+Weight Component<Cost, Weight>::getWeight() {
+  return weight;
+}
+
+// Returns the nodes of the component
+template <typename Cost, typename Weight>
+const std::vector<unsigned int>& Component<Cost, Weight>::getNodes() {
+  return nodes;
+}
+
+// output of the tree of the component in the format of graphs, the node count
+// is the size of the component
+template <typename Cost, typename Weight>
+std::ostream& operator<<(std::ostream& out, const Component<Cost, Weight>& o) {
+  writeGraph(out, o.nodes.size(), o.weight, o.edges);
+  return out;
+}
+
+// binary output of the tree of the component, see writeGraphBinary
+template <typename Cost, typename Weight>
+void Component<Cost, Weight>::exportBinary(std::ostream& out) {
+  writeGraphBinary(out, nodes.size(), weight, edges);
+}
+
+// Returns the sorted blocks of edges
+const std::deque<std::vector<Edge<long long int>>>& SortedBlocks::getBlocks() {
+  return blocks;
+}
+
+// Returns the edges of the graph, for a result of kruskal in the order in
+// which they were added
+template <typename Cost, typename Weight>
+const std::vector<Edge<Cost>>& Graph<Cost, Weight>::getEdges() {
+  return edges;
+}
+
+// Adds the edges given by next() in order of increasing cost to res if they
+// connect different union find trees, next() returns nullptr after the last
+// edge. The scan stops as soon as componentCount components are left. If
+// components is given, it gets the connected components of res with their
+// trees, ordered by their smallest node.
+template <typename Cost, typename Weight, typename Next>
+void kruskalScan(Next next, Graph<Cost, Weight>& res, std::vector<Component<Cost, Weight>>* components,
+  unsigned int componentCount) {
+  UnionFind uf(res.getNodeCount());
+
+  // if res is a tree (resp. has componentCount trees), we are done
+  while (res.getEdgeCount() + componentCount < res.getNodeCount()) {
+    const Edge<Cost>* e = next();
+    if (e == nullptr) {
+      break;
+    }
+
+    if (uf.find(e->getA()) != uf.find(e->getB())) {
+      res.addEdge(*e);
+      uf.un(e->getA(), e->getB());
+    }
+  }
+
+  if (components == nullptr) {
+    return;
+  }
+
+  // The union find trees are the components of the forest
+  components->clear();
+  const unsigned int none = ~0u;
+  std::vector<unsigned int> index(res.getNodeCount(), none);
+  for (unsigned int a = 0; a < res.getNodeCount(); a++) {
+    unsigned int root = uf.find(a);
+    if (index[root] == none) {
+      // first node of the component
+      index[root] = components->size();
+      components->push_back(Component<Cost, Weight>());
+    }
+    (*components)[index[root]].addNode(a);
+  }
+  for (const Edge<Cost>& e : res.getEdges()) {
+    (*components)[index[uf.find(e.getA())]].addEdge(e);
+  }
+}
+
 // Makes res an MST of the graph using kruskal algorithm with union find data structure
+// If the graph is not connected, res is a minimum spanning forest. If
+// components is given, it gets the connected components with their trees,
+// ordered by their smallest node.
+// The scan stops as soon as componentCount components are left, which gives
+// a single linkage clustering with componentCount clusters (or more, if the
+// graph has more components).
 // res has to be empty
-void Graph::kruskal(Graph& res) {
+template <typename Cost, typename Weight>
+void Graph<Cost, Weight>::kruskal(Graph& res, std::vector<Component<Cost, Weight>>* components,
+  unsigned int componentCount) {
   res.initGraph(getNodeCount());
-  UnionFind uf(getNodeCount());
 
+  Trace::Scope sorting("sort");
   sortEdges();
+  sorting.end();
+
+  Trace::Scope scanning("scan");
+  auto it = edges.begin();
+  kruskalScan([&]() -> const Edge<Cost>* {
+    return it == edges.end() ? nullptr : &*it++;
+  }, res, components, componentCount);
+}
+
+// Sorts a block of edges by cost
+void sortBlock(std::vector<Edge<long long int>>& block) {
+  Trace::Scope sorting("sort block");
+  std::sort(block.begin(), block.end(), cmp<long long int>);
+}
+
+// Parses a graph file in pieces. Only complete lines are parsed before the
+// end of the file. Like a stream, parsing stops at the first malformed edge.
+SortedBlocks::SortedBlocks(std::string filename, unsigned int threadCount, std::size_t blockSize) {
+  std::fstream file(filename, std::ios_base::in | std::ios_base::binary);
+
+  // Check if file is open
+  if (!file.is_open()) {
+    nodeCount = 0;
+    std::cout << "Input file does not exist." << '\n';
+    return;
+  }
+
+  threadCount = std::max(1u, threadCount);
+  std::deque<std::thread> sorters;
+  std::vector<Edge<long long int>> block;
+  block.reserve(blockSize);
+  // Hands the block to a new thread, after waiting for the oldest one if
+  // threadCount blocks are being sorted
+  auto finishBlock = [&]() {
+    blocks.push_back(std::move(block));
+    block = std::vector<Edge<long long int>>();
+    block.reserve(blockSize);
+    if (sorters.size() == threadCount) {
+      sorters.front().join();
+      sorters.pop_front();
+    }
+    sorters.push_back(std::thread(sortBlock, std::ref(blocks.back())));
+  };
+
+  std::vector<char> piece(1 << 20);
+  std::string text;
+  bool first = true;
+  bool stopped = false;
+  nodeCount = 0;
+  while (!stopped && file) {
+    file.read(piece.data(), piece.size());
+    text.append(piece.data(), file.gcount());
+    std::size_t length = file ? text.rfind('\n') + 1 : text.size();
+    const char* p = text.data();
+    const char* end = p + length;
+
+    long long int a, b, cost;
+    if (first && length > 0) {
+      readNumber(p, end, a);
+      nodeCount = a;
+      first = false;
+    }
+    while (readNumber(p, end, a) && readNumber(p, end, b) && readNumber(p, end, cost)) {
+      if (a < 0 || b < 0 || a >= nodeCount || b >= nodeCount) {
+        std::cout << "Wrong use of addEdge." << '\n';
+        continue;
+      }
+      block.push_back(Edge<long long int>(a, b, cost));
+      edgeCount++;
+      maxCost = std::max(maxCost, cost < 0 ? -cost : cost);
+      if (block.size() == blockSize) {
+        finishBlock();
+      }
+    }
+    stopped = p != end;
+    text.erase(0, length);
+  }
+  if (!block.empty()) {
+    finishBlock();
+  }
+  for (std::thread& t : sorters) {
+    t.join();
+  }
+}
+
+// Returns the node count of the file
+unsigned int SortedBlocks::getNodeCount() {
+  return nodeCount;
+}
+
+// Returns the number of edges of the file
+unsigned int SortedBlocks::getEdgeCount() {
+  return edgeCount;
+}
+
+// Returns the largest absolute value of the costs
+long long int SortedBlocks::getMaxCost() {
+  return maxCost;
+}
+
+// Makes res an MST like Graph::kruskal, the edges are taken from the blocks
+// with a multiway merge. Blocks which are not needed any more are not read.
+template <typename Cost, typename Weight>
+void SortedBlocks::kruskal(Graph<Cost, Weight>& res, std::vector<Component<Cost, Weight>>* components,
+  unsigned int componentCount) {
+  res.initGraph(getNodeCount());
+
+  // min heap of the blocks by the cost of their next edge
+  std::vector<std::size_t> pos(blocks.size(), 0);
+  auto later = [&](unsigned int i, unsigned int j) {
+    return blocks[i][pos[i]].getCost() > blocks[j][pos[j]].getCost();
+  };
+  std::vector<unsigned int> heap;
+  for (unsigned int i = 0; i < blocks.size(); i++) {
+    heap.push_back(i);
+  }
+  std::make_heap(heap.begin(), heap.end(), later);
+
+  Trace::Scope scanning("merge and scan");
+  Edge<Cost> current(0, 0, 0);
+  kruskalScan([&]() -> const Edge<Cost>* {
+    if (heap.empty()) {
+      return nullptr;
+    }
+    std::pop_heap(heap.begin(), heap.end(), later);
+    unsigned int i = heap.back();
+    const Edge<long long int>& e = blocks[i][pos[i]++];
+    current = Edge<Cost>(e.getA(), e.getB(), static_cast<Cost>(e.getCost()));
+    if (pos[i] < blocks[i].size()) {
+      std::push_heap(heap.begin(), heap.end(), later);
+    } else {
+      heap.pop_back();
+    }
+    return &current;
+  }, res, components, componentCount);
+}
+
+// Roots every tree of the forest and computes the lifting tables
+template <typename Cost>
+PathMaxima<Cost>::PathMaxima(unsigned int nodeCount, const std::vector<Edge<Cost>>& edges) :
+  component(nodeCount, nodeCount), componentMax(nodeCount, std::numeric_limits<Cost>::min()), depth(nodeCount, 0) {
+  // adjacency lists of the forest
+  std::vector<unsigned int> start(nodeCount + 1, 0);
+  for (const Edge<Cost>& e : edges) {
+    start[e.getA()+1]++;
+    start[e.getB()+1]++;
+  }
+  for (unsigned int i = 0; i < nodeCount; i++) {
+    start[i+1] += start[i];
+  }
+  std::vector<unsigned int> pos(start.begin(), start.end() - 1);
+  std::vector<unsigned int> incident(2*edges.size());
+  for (unsigned int e = 0; e < edges.size(); e++) {
+    incident[pos[edges[e].getA()]++] = e;
+    incident[pos[edges[e].getB()]++] = e;
+  }
+
+  unsigned int levels = 1;
+  while ((1u << levels) < nodeCount) {
+    levels++;
+  }
+  up.assign(levels, std::vector<unsigned int>(nodeCount));
+  maxCost.assign(levels, std::vector<Cost>(nodeCount, 0));
+
+  // breadth first search from every root, the root is its own parent
+  std::vector<unsigned int> queue;
+  queue.reserve(nodeCount);
+  for (unsigned int root = 0; root < nodeCount; root++) {
+    if (component[root] != nodeCount) {
+      continue;
+    }
+    component[root] = root;
+    up[0][root] = root;
+    queue.push_back(root);
+    for (unsigned int i = queue.size() - 1; i < queue.size(); i++) {
+      unsigned int a = queue[i];
+      for (unsigned int j = start[a]; j < start[a+1]; j++) {
+        const Edge<Cost>& e = edges[incident[j]];
+        unsigned int b = e.getA() == a ? e.getB() : e.getA();
+        if (component[b] == nodeCount) {
+          component[b] = root;
+          depth[b] = depth[a] + 1;
+          up[0][b] = a;
+          maxCost[0][b] = e.getCost();
+          componentMax[root] = std::max(componentMax[root], e.getCost());
+          queue.push_back(b);
+        }
+      }
+    }
+  }
+
+  for (unsigned int j = 1; j < levels; j++) {
+    for (unsigned int a = 0; a < nodeCount; a++) {
+      unsigned int mid = up[j-1][a];
+      up[j][a] = up[j-1][mid];
+      maxCost[j][a] = std::max(maxCost[j-1][a], maxCost[j-1][mid]);
+    }
+  }
+}
+
+// Gets the largest cost on the path between a and b, returns false if they
+// are in different trees
+template <typename Cost>
+bool PathMaxima<Cost>::maxOnPath(unsigned int a, unsigned int b, Cost& res) {
+  if (component[a] != component[b]) {
+    return false;
+  }
+
+  res = std::numeric_limits<Cost>::min();
+  if (depth[a] < depth[b]) {
+    std::swap(a, b);
+  }
+  // lift a to the depth of b
+  for (unsigned int j = 0, diff = depth[a] - depth[b]; diff != 0; j++, diff >>= 1) {
+    if (diff & 1) {
+      res = std::max(res, maxCost[j][a]);
+      a = up[j][a];
+    }
+  }
+  if (a == b) {
+    return true;
+  }
+  // lift both to the children of the lowest common ancestor
+  for (unsigned int j = up.size(); j-- > 0; ) {
+    if (up[j][a] != up[j][b]) {
+      res = std::max(res, std::max(maxCost[j][a], maxCost[j][b]));
+      a = up[j][a];
+      b = up[j][b];
+    }
+  }
+  res = std::max(res, std::max(maxCost[0][a], maxCost[0][b]));
+  return true;
+}
+
+// Checks whether cost is at least the largest cost on the path between a and
+// b. Most edges are at least as expensive as every edge of the tree, which is
+// checked first.
+template <typename Cost>
+bool PathMaxima<Cost>::exceedsPath(unsigned int a, unsigned int b, Cost cost) {
+  if (component[a] != component[b]) {
+    return false;
+  }
+  if (cost >= componentMax[component[a]]) {
+    return true;
+  }
+  Cost pathMax;
+  maxOnPath(a, b, pathMax);
+  return cost >= pathMax;
+}
+
+// Replays the merges of kruskal on the forest and builds the leaf order
+template <typename Cost>
+BottleneckIndex<Cost>::BottleneckIndex(unsigned int nodeCount, const std::vector<Edge<Cost>>& forest) :
+  position(nodeCount), component(nodeCount) {
+  // Leaf list of every union find tree, next[a] follows a and gap[a] is the
+  // LCA cost of a and next[a]
+  const unsigned int none = ~0u;
+  std::vector<unsigned int> next(nodeCount, none);
+  std::vector<Cost> gap(nodeCount, 0);
+  std::vector<unsigned int> first(nodeCount);
+  std::vector<unsigned int> last(nodeCount);
+  for (unsigned int a = 0; a < nodeCount; a++) {
+    first[a] = a;
+    last[a] = a;
+  }
+
+  UnionFind uf(nodeCount);
+  for (const Edge<Cost>& e : forest) {
+    unsigned int rA = uf.find(e.getA());
+    unsigned int rB = uf.find(e.getB());
+    next[last[rA]] = first[rB];
+    gap[last[rA]] = e.getCost();
+    unsigned int head = first[rA];
+    unsigned int tail = last[rB];
+    uf.un(rA, rB);
+    first[uf.find(rA)] = head;
+    last[uf.find(rA)] = tail;
+  }
+
+  // Concatenate the lists of all trees, the gaps between trees are never used
+  std::vector<Cost> gaps;
+  gaps.reserve(nodeCount);
+  for (unsigned int root = 0; root < nodeCount; root++) {
+    if (uf.find(root) != root) {
+      continue;
+    }
+    for (unsigned int a = first[root]; a != none; a = next[a]) {
+      position[a] = gaps.size();
+      component[a] = root;
+      gaps.push_back(gap[a]);
+    }
+  }
+
+  // Sparse table for the range maxima
+  table.push_back(gaps);
+  for (unsigned int j = 1; (1u << j) <= nodeCount; j++) {
+    const std::vector<Cost>& prev = table.back();
+    std::vector<Cost> level(nodeCount - (1u << j) + 1);
+    for (unsigned int i = 0; i < level.size(); i++) {
+      level[i] = std::max(prev[i], prev[i + (1u << (j-1))]);
+    }
+    table.push_back(level);
+  }
+}
+
+// Gets the bottleneck cost between a and b, returns false if there is no path
+template <typename Cost>
+bool BottleneckIndex<Cost>::bottleneck(unsigned int a, unsigned int b, Cost& res) {
+  if (component[a] != component[b]) {
+    return false;
+  }
+  res = 0;
+  unsigned int i = std::min(position[a], position[b]);
+  unsigned int j = std::max(position[a], position[b]);
+  if (i == j) {
+    return true;
+  }
+  // maximum of the gaps i, ..., j-1
+  unsigned int level = 31 - __builtin_clz(j - i);
+  res = std::max(table[level][i], table[level][j - (1u << level)]);
+  return true;
+}
+
+// Makes res an MST of the graph like kruskal, but only sorts a sparse part of
+// the edges. The k lightest edges of every node are the candidates, kruskal
+// computes a forest of them. All other edges are checked against the maximum
+// cost on the path between their nodes in the forest, only cheaper edges (and
+// edges between different trees) can be part of an MST. A second kruskal run
+// on the forest and these edges gives the result.
+// res has to be empty
+template <typename Cost, typename Weight>
+void Graph<Cost, Weight>::sparseKruskal(Graph& res, unsigned int k, std::vector<Component<Cost, Weight>>* components,
+  unsigned int componentCount) {
+  // incident edges of every node
+  std::vector<unsigned int> start(getNodeCount() + 1, 0);
+  for (const Edge<Cost>& e : edges) {
+    start[e.getA()+1]++;
+    start[e.getB()+1]++;
+  }
+  for (unsigned int i = 0; i < getNodeCount(); i++) {
+    start[i+1] += start[i];
+  }
+  std::vector<unsigned int> pos(start.begin(), start.end() - 1);
+  std::vector<unsigned int> incident(2*edges.size());
+  for (unsigned int e = 0; e < edges.size(); e++) {
+    incident[pos[edges[e].getA()]++] = e;
+    incident[pos[edges[e].getB()]++] = e;
+  }
+
+  // the k lightest edges of every node are selected without sorting
+  std::vector<bool> candidate(edges.size(), false);
+  auto lighter = [this](unsigned int e, unsigned int f) {
+    return edges[e].getCost() < edges[f].getCost();
+  };
+  for (unsigned int a = 0; a < getNodeCount(); a++) {
+    auto first = incident.begin() + start[a];
+    auto last = incident.begin() + start[a+1];
+    if (static_cast<unsigned int>(last - first) > k) {
+      std::nth_element(first, first + k, last, lighter);
+      last = first + k;
+    }
+    for (auto it = first; it != last; ++it) {
+      candidate[*it] = true;
+    }
+  }
+
+  Graph candidates(getNodeCount());
+  for (unsigned int e = 0; e < edges.size(); e++) {
+    if (candidate[e]) {
+      candidates.addEdge(edges[e]);
+    }
+  }
+  Graph forest;
+  candidates.kruskal(forest);
+
+  // The other edges are only needed if they are cheaper than the forest path
+  PathMaxima<Cost> maxima(getNodeCount(), forest.edges);
+  Graph sparse(forest);
+  for (unsigned int e = 0; e < edges.size(); e++) {
+    if (!candidate[e] && !maxima.exceedsPath(edges[e].getA(), edges[e].getB(), edges[e].getCost())) {
+      sparse.addEdge(edges[e]);
+    }
+  }
+
+  sparse.kruskal(res, components, componentCount);
+}
+
+// Command line options
+struct Options {
+  std::string outputfile;
+  bool binary = false;
+  // number of candidate edges per node for sparseKruskal, 0 for kruskal
+  unsigned int candidates = 0;
+  // the tree of component i is written to componentPrefix + i if it is set
+  std::string componentPrefix;
+  // number of clusters, the kruskal scan stops when they are left
+  unsigned int clusters = 1;
+  // file for the cluster of every node
+  std::string labelfile;
+  // file with pairs of nodes for bottleneck queries
+  std::string queryfile;
+  // number of threads for parsing the input file (and sorting in the
+  // pipelined mode)
+  unsigned int threadCount = std::thread::hardware_concurrency();
+  // sort blocks of edges while the file is read, only without candidates
+  bool pipelined = false;
+  // check the result with a certificate
+  bool verify = false;
+};
+
+// Writes the MST (or minimum spanning forest) res with its components. For a
+// graph which is not connected, the components are listed.
+template <typename G>
+void writeResult(G& res, std::vector<typename G::ComponentType>& components, Options& o) {
+  if (components.size() > 1) {
+    Writer w(std::cout);
+    if (o.clusters > 1) {
+      w.writeString("The graph was split into ");
+      w.writeUInt(components.size());
+      w.writeString(" clusters.\n");
+    } else {
+      w.writeString("The graph is not connected, it has ");
+      w.writeUInt(components.size());
+      w.writeString(" components.\n");
+    }
+    for (unsigned int i = 0; i < components.size(); i++) {
+      w.writeString("Component ");
+      w.writeUInt(i);
+      w.writeString(": ");
+      w.writeUInt(components[i].getNodeCount());
+      w.writeString(" nodes, ");
+      w.writeUInt(components[i].getEdgeCount());
+      w.writeString(" edges, weight ");
+      w.writeInt(components[i].getWeight());
+      w.writeChar('\n');
+    }
+  }
+
+  if (o.outputfile == "c") {
+    if (o.binary) {
+      res.exportBinary(std::cout);
+    } else {
+      std::cout << res << '\n';
+    }
+  } else if (o.binary) {
+    std::fstream file(o.outputfile, std::ios_base::out | std::ios_base::binary);
+    res.exportBinary(file);
+  } else {
+    std::fstream file(o.outputfile, std::ios_base::out);
+    file << res;
+  }
+
+  // The cluster (component) of every node, one per line
+  if (!o.labelfile.empty()) {
+    std::vector<unsigned int> labels(res.getNodeCount());
+    for (unsigned int i = 0; i < components.size(); i++) {
+      for (unsigned int a : components[i].getNodes()) {
+        labels[a] = i;
+      }
+    }
+    std::fstream file(o.labelfile, std::ios_base::out);
+    Writer w(file);
+    for (unsigned int label : labels) {
+      w.writeUInt(label);
+      w.writeChar('\n');
+    }
+  }
+
+  // Bottleneck queries, the answer to every pair of nodes is written to the
+  // console (- if there is no path)
+  if (!o.queryfile.empty()) {
+    BottleneckIndex<typename G::CostType> index(res.getNodeCount(), res.getEdges());
+    std::fstream file(o.queryfile, std::ios_base::in);
+    if (!file.is_open()) {
+      std::cout << "Query file does not exist." << '\n';
+    }
+    Writer w(std::cout);
+    unsigned int a, b;
+    while (file >> a >> b) {
+      typename G::CostType cost;
+      if (a >= res.getNodeCount() || b >= res.getNodeCount() || !index.bottleneck(a, b, cost)) {
+        w.writeChar('-');
+      } else {
+        w.writeInt(cost);
+      }
+      w.writeChar('\n');
+    }
+  }
 
-  for (Edge e : edges) {
+  // The tree of every component in its own file
+  if (!o.componentPrefix.empty()) {
+    for (unsigned int i = 0; i < components.size(); i++) {
+      std::string name = o.componentPrefix + std::to_string(i);
+      if (o.binary) {
+        std::fstream file(name, std::ios_base::out | std::ios_base::binary);
+        components[i].exportBinary(file);
+      } else {
+        std::fstream file(name, std::ios_base::out);
+        file << components[i];
+      }
+    }
+  }
+}
+
+// Returns the edges of a forest without the edges which close a cycle
+template <typename Cost>
+std::vector<Edge<Cost>> withoutCycles(unsigned int nodeCount, const std::vector<Edge<Cost>>& edges) {
+  std::vector<Edge<Cost>> res;
+  UnionFind uf(nodeCount);
+  for (const Edge<Cost>& e : edges) {
     if (uf.find(e.getA()) != uf.find(e.getB())) {
-      res.addEdge(e);
       uf.un(e.getA(), e.getB());
+      res.push_back(e);
     }
+  }
+  return res;
+}
 
-    // if res is a tree, we are done
-    if(res.getEdgeCount() == getNodeCount()-1) {
-      return;
+// Prepares the checks of the edges, the forest edges are indexed by their
+// nodes. There are at most as many clusters as nodes.
+template <typename Cost, typename Weight>
+ForestVerifier<Cost, Weight>::ForestVerifier(Graph<Cost, Weight>& forest, unsigned int clusterCount) :
+  nodeCount(forest.getNodeCount()), clusterCount(std::min(clusterCount, forest.getNodeCount())), maxForestCost(std::numeric_limits<Cost>::min()),
+  paths(forest.getNodeCount(), withoutCycles(forest.getNodeCount(), forest.getEdges())) {
+  if (withoutCycles(nodeCount, forest.getEdges()).size() != forest.getEdgeCount()) {
+    fail("the forest has a cycle");
+  }
+  treeCount = nodeCount - forest.getEdgeCount();
+
+  for (const Edge<Cost>& e : forest.getEdges()) {
+    unsigned long long int key = static_cast<unsigned long long int>(e.getA()) << 32 | e.getB();
+    if (!forestEdges.insert(std::make_pair(key, forestCosts.size())).second) {
+      fail("the forest has parallel edges");
     }
+    forestCosts.push_back(e.getCost());
+    maxForestCost = std::max(maxForestCost, e.getCost());
   }
+  found.assign(forestCosts.size(), false);
 }
 
-int main(int argc, char** argv) {
-  std::string filename;
-  std::string outputfile;
+// Records a failed check, the first reason is kept
+template <typename Cost, typename Weight>
+void ForestVerifier<Cost, Weight>::fail(std::string reason) {
+  if (valid) {
+    error = reason;
+  }
+  valid = false;
+}
 
-  if (argc <= 1) {
-    std::cout << "Please enter a source filename:" << '\n';
-    std::cin >> filename;
+// Checks an edge of the graph
+template <typename Cost, typename Weight>
+void ForestVerifier<Cost, Weight>::check(unsigned int a, unsigned int b, Cost cost) {
+  // Edges with non-existing nodes are not part of the graph
+  if (a >= nodeCount || b >= nodeCount) {
+    return;
+  }
+  if (a > b) {
+    std::swap(a, b);
+  }
+
+  auto it = forestEdges.find(static_cast<unsigned long long int>(a) << 32 | b);
+  if (it != forestEdges.end() && forestCosts[it->second] == cost) {
+    found[it->second] = true;
+  }
+
+  Cost pathMax;
+  if (paths.maxOnPath(a, b, pathMax)) {
+    if (cost < pathMax) {
+      fail("the edge {" + std::to_string(a) + ", " + std::to_string(b) + "} is cheaper than the forest path");
+    }
   } else {
-    filename.append(argv[1]);
+    betweenTrees = true;
+    if (clusterCount <= 1) {
+      fail("the edge {" + std::to_string(a) + ", " + std::to_string(b) + "} connects two trees");
+    } else if (cost < maxForestCost) {
+      fail("the edge {" + std::to_string(a) + ", " + std::to_string(b) + "} between two clusters is too cheap");
+    }
   }
+}
 
-  std::cout << "Please enter an output filename or \"c\" for console output:" << '\n';
-  std::cin >> outputfile;
+// Prints and returns the result after all edges were checked
+template <typename Cost, typename Weight>
+bool ForestVerifier<Cost, Weight>::finish() {
+  if (std::find(found.begin(), found.end(), false) != found.end()) {
+    fail("the forest has an edge which is not in the graph");
+  }
+  if ((betweenTrees && treeCount != clusterCount) || (treeCount < clusterCount && !forestCosts.empty())) {
+    fail("the forest has the wrong number of trees");
+  }
 
-  Graph g(filename);
+  if (valid) {
+    std::cout << "Verification passed." << '\n';
+  } else {
+    std::cout << "Verification failed: " << error << "." << '\n';
+  }
+  return valid;
+}
 
-  if (g.getNodeCount() == 0) {
-    return 0;
+// Computes the MST with the graph type G and writes it
+template <typename G>
+void solve(Instance& instance, Options& o) {
+  Trace::Scope building("build graph");
+  G g(instance);
+  building.end();
+
+  G res;
+  std::vector<typename G::ComponentType> components;
+  if (o.candidates > 0) {
+    g.sparseKruskal(res, o.candidates, &components, o.clusters);
+  } else {
+    g.kruskal(res, &components, o.clusters);
   }
+  Trace::Scope writing("write output");
+  writeResult(res, components, o);
+  writing.end();
+
+  if (o.verify) {
+    Trace::Scope verifying("verify");
+    ForestVerifier<typename G::CostType, typename G::WeightType> verifier(res, o.clusters);
+    for (const auto& e : g.getEdges()) {
+      verifier.check(e.getA(), e.getB(), e.getCost());
+    }
+    verifier.finish();
+  }
+}
 
-  Graph res;
-  g.kruskal(res);
+// Computes the MST of the sorted blocks with the graph type G and writes it
+template <typename G>
+void solve(SortedBlocks& blocks, Options& o) {
+  G res;
+  std::vector<typename G::ComponentType> components;
+  blocks.kruskal(res, &components, o.clusters);
+  Trace::Scope writing("write output");
+  writeResult(res, components, o);
+  writing.end();
 
-  if (outputfile == "c") {
-    if (res.getEdgeCount() != res.getNodeCount()-1) {
-      std::cout << "The graph is not connected." << "\n";
+  if (o.verify) {
+    Trace::Scope verifying("verify");
+    ForestVerifier<typename G::CostType, typename G::WeightType> verifier(res, o.clusters);
+    for (const auto& block : blocks.getBlocks()) {
+      for (const auto& e : block) {
+        verifier.check(e.getA(), e.getB(), static_cast<typename G::CostType>(e.getCost()));
+      }
+    }
+    verifier.finish();
+  }
+}
+
+// Solves the instance (an Instance or SortedBlocks) with the narrowest cost
+// types it fits into. The weight of the input graph is at most m times the
+// largest cost.
+template <typename I>
+void chooseTypesAndSolve(I& instance, Options& o) {
+  long long int maxCost = instance.getMaxCost();
+  bool smallWeight = maxCost == 0 || instance.getEdgeCount() <= std::numeric_limits<int>::max()/maxCost;
+  if (maxCost <= std::numeric_limits<short int>::max()) {
+    if (smallWeight) {
+      solve<Graph<short int, int>>(instance, o);
     } else {
-      std::cout << res << '\n';
+      solve<Graph<short int, long long int>>(instance, o);
+    }
+  } else if (maxCost <= std::numeric_limits<int>::max()) {
+    if (smallWeight) {
+      solve<Graph<int, int>>(instance, o);
+    } else {
+      solve<Graph<int, long long int>>(instance, o);
     }
   } else {
-    if (res.getEdgeCount() != res.getNodeCount()-1) {
-      std::cout << "The graph is not connected." << "\n";
+    solve<Graph<long long int, long long int>>(instance, o);
+  }
+}
+
+int main(int argc, char** argv) {
+  std::string filename;
+  Options o;
+
+  for (int i=1; i<argc; i++) {
+    if (argv[i][0] == '-') {
+      // Write the tree in binary format
+      if (argv[i][1] == 'b') {
+        o.binary = true;
+      } else if (argv[i][1] == 'k') {
+        // Sparse mode with the given number of candidate edges per node
+        if (i+1 < argc) {
+          try {
+            o.candidates = std::stoul(argv[i+1]);
+          } catch (std::logic_error&) {
+            std::cout << "Invalid candidate count " << argv[i+1] << "." << '\n';
+            return 0;
+          }
+          i++;
+        }
+      } else if (argv[i][1] == 'c') {
+        // Stop when the given number of clusters is left
+        if (i+1 < argc) {
+          try {
+            o.clusters = std::stoul(argv[i+1]);
+          } catch (std::logic_error&) {
+            std::cout << "Invalid cluster count " << argv[i+1] << "." << '\n';
+            return 0;
+          }
+          i++;
+        }
+      } else if (argv[i][1] == 'l') {
+        // Write the cluster of every node to a file
+        if (i+1 < argc) {
+          o.labelfile = argv[i+1];
+          i++;
+        }
+      } else if (argv[i][1] == 'q') {
+        // Answer the bottleneck queries of a file
+        if (i+1 < argc) {
+          o.queryfile = argv[i+1];
+          i++;
+        }
+      } else if (std::string(argv[i]) == "--verify") {
+        // Check the result with a certificate
+        o.verify = true;
+      } else if (std::string(argv[i]) == "--trace") {
+        // Write a timeline of the phases at exit
+        if (i+1 < argc) {
+          Trace::enable(argv[i+1]);
+          i++;
+        }
+      } else if (argv[i][1] == 'p') {
+        // Sort the edges in blocks while the file is read
+        o.pipelined = true;
+      } else if (argv[i][1] == 'j') {
+        // Number of threads for parsing
+        if (i+1 < argc) {
+          try {
+            o.threadCount = std::stoul(argv[i+1]);
+          } catch (std::logic_error&) {
+            std::cout << "Invalid thread count " << argv[i+1] << "." << '\n';
+            return 0;
+          }
+          i++;
+        }
+      } else if (argv[i][1] == 's') {
+        // Write the tree of every component to its own file
+        if (i+1 < argc) {
+          o.componentPrefix = argv[i+1];
+          i++;
+        }
+      }
     } else {
-      std::fstream file(outputfile, std::ios_base::out);
-      file << res;
+      filename = argv[i];
+    }
+  }
+
+  if (filename.empty()) {
+    std::cout << "Please enter a source filename:" << '\n';
+    std::cin >> filename;
+  }
+
+  std::cout << "Please enter an output filename or \"c\" for console output:" << '\n';
+  std::cin >> o.outputfile;
+
+  if (o.pipelined && o.candidates == 0) {
+    Trace::Scope loading("parse and sort blocks");
+    SortedBlocks blocks(filename, o.threadCount);
+    loading.end();
+    if (blocks.getNodeCount() > 0) {
+      chooseTypesAndSolve(blocks, o);
     }
+    return 0;
+  }
+
+  Trace::Scope loading("load instance");
+  Instance instance(filename, o.threadCount);
+  loading.end();
+  if (instance.getNodeCount() > 0) {
+    chooseTypesAndSolve(instance, o);
   }
 
   return 0;
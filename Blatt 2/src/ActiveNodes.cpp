@@ -0,0 +1,116 @@
+#include "ActiveNodes.h"
+#include "Arena.h"
+
+// The constant is passed to the vector constructors by reference and needs a
+// definition
+const unsigned int LabelBuckets::none;
+
+// Constructor, labels have to be smaller than labelCount
+LabelBuckets::LabelBuckets(unsigned int nodeCount, unsigned int labelCount, Arena& arena) :
+  first(labelCount, none, ArenaAllocator<unsigned int>(arena)),
+  next(nodeCount, none, ArenaAllocator<unsigned int>(arena)),
+  prev(nodeCount, none, ArenaAllocator<unsigned int>(arena)),
+  bucket(nodeCount, none, ArenaAllocator<unsigned int>(arena)) {
+  lowest = labelCount;
+}
+
+// Inserts a node into the bucket of its label, the node must not be contained
+void LabelBuckets::insert(unsigned int a, unsigned int label) {
+  next[a] = first[label];
+  prev[a] = none;
+  if (first[label] != none) {
+    prev[first[label]] = a;
+  }
+  first[label] = a;
+  bucket[a] = label;
+  count++;
+
+  if (label > highest) {
+    highest = label;
+  }
+  if (label < lowest) {
+    lowest = label;
+  }
+}
+
+// Removes a contained node
+void LabelBuckets::remove(unsigned int a) {
+  if (prev[a] != none) {
+    next[prev[a]] = next[a];
+  } else {
+    first[bucket[a]] = next[a];
+  }
+  if (next[a] != none) {
+    prev[next[a]] = prev[a];
+  }
+  bucket[a] = none;
+  count--;
+}
+
+// Checks whether a node is contained
+bool LabelBuckets::contains(unsigned int a) {
+  return bucket[a] != none;
+}
+
+// Checks whether there is no node
+bool LabelBuckets::empty() {
+  return count == 0;
+}
+
+// Removes and returns a node with the highest label, there has to be one
+unsigned int LabelBuckets::pop() {
+  while (first[highest] == none) {
+    highest--;
+  }
+  unsigned int a = first[highest];
+  remove(a);
+  return a;
+}
+
+// Removes and returns a node with the lowest label, there has to be one
+unsigned int LabelBuckets::popLowest() {
+  while (first[lowest] == none) {
+    lowest++;
+  }
+  unsigned int a = first[lowest];
+  remove(a);
+  return a;
+}
+
+// Constructor, the ring has space for every node
+FifoQueue::FifoQueue(unsigned int nodeCount, Arena& arena) :
+  ring(nodeCount, 0, ArenaAllocator<unsigned int>(arena)),
+  queued(nodeCount, 0, ArenaAllocator<unsigned char>(arena)) { }
+
+// Appends a node which is not contained, the label is not used
+void FifoQueue::insert(unsigned int a, unsigned int) {
+  unsigned int pos = head + count;
+  if (pos >= ring.size()) {
+    pos -= ring.size();
+  }
+  ring[pos] = a;
+  queued[a] = 1;
+  count++;
+}
+
+// Checks whether a node is contained
+bool FifoQueue::contains(unsigned int a) {
+  return queued[a] != 0;
+}
+
+// Checks whether there is no node
+bool FifoQueue::empty() {
+  return count == 0;
+}
+
+// Removes and returns the oldest node, there has to be one
+unsigned int FifoQueue::pop() {
+  unsigned int a = ring[head];
+  queued[a] = 0;
+  head++;
+  if (head == ring.size()) {
+    head = 0;
+  }
+  count--;
+  return a;
+}
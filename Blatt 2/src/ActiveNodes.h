@@ -0,0 +1,63 @@
+#ifndef ACTIVENODES_H
+#define ACTIVENODES_H
+
+#include "Arena.h"
+
+// Data structures for the active nodes of the push relabel algorithm. A node
+// is contained at most once, all memory is taken from an arena when the
+// structure is created.
+
+// Strategies for choosing the next active node
+enum ActiveSelection {
+  // the node with the highest label is discharged first
+  HIGHEST_LABEL,
+  // the nodes are discharged in the order in which they became active
+  FIFO,
+  // excess scaling: a node with large excess and the lowest label is chosen,
+  // the pushes are limited so that no node gets too much excess
+  EXCESS_SCALING
+};
+
+// Active nodes in buckets by label. The buckets are doubly linked lists whose
+// links are stored in arrays indexed by node id, so inserting and removing
+// needs no allocation.
+class LabelBuckets {
+public:
+  LabelBuckets(unsigned int nodeCount, unsigned int labelCount, Arena& arena);
+  void insert(unsigned int a, unsigned int label);
+  void remove(unsigned int a);
+  bool contains(unsigned int a);
+  bool empty();
+  unsigned int pop();
+  unsigned int popLowest();
+private:
+  static const unsigned int none = ~0u;
+
+  // first node of every bucket
+  ArenaVector<unsigned int> first;
+  // links of the nodes and the bucket of every node (none if not contained)
+  ArenaVector<unsigned int> next;
+  ArenaVector<unsigned int> prev;
+  ArenaVector<unsigned int> bucket;
+  unsigned int count = 0;
+  // bounds for the highest and lowest non-empty bucket
+  unsigned int highest = 0;
+  unsigned int lowest = 0;
+};
+
+// Active nodes in a ring buffer, they are removed in insertion order
+class FifoQueue {
+public:
+  FifoQueue(unsigned int nodeCount, Arena& arena);
+  void insert(unsigned int a, unsigned int label);
+  bool contains(unsigned int a);
+  bool empty();
+  unsigned int pop();
+private:
+  ArenaVector<unsigned int> ring;
+  ArenaVector<unsigned char> queued;
+  unsigned int head = 0;
+  unsigned int count = 0;
+};
+
+#endif
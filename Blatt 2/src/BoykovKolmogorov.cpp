@@ -0,0 +1,272 @@
+#include <vector>
+#include <stdexcept>
+#include "Graph.h"
+#include "ActiveNodes.h"
+#include "Arena.h"
+#include "Trace.h"
+
+// Boykov-Kolmogorov algorithm
+//
+// Works on the residual graph, whose arcs are numbered 2e (tails[e] ->
+// heads[e], residual capacity capacities[e] - flows[e]) and 2e+1 (heads[e] ->
+// tails[e], residual capacity flows[e]). The arc a^1 is the reverse of arc a.
+//
+// Two search trees are grown, one from s over arcs with residual capacity and
+// one towards t. When they touch, the flow is augmented along the path through
+// both trees. Nodes cut off from their tree by saturated arcs become orphans,
+// which look for a new parent in their tree or are freed. The trees are kept
+// between the augmentations, which is what makes the algorithm fast on
+// instances with many short augmenting paths.
+
+namespace {
+
+const unsigned int noParent = ~0u;
+const unsigned int terminal = ~0u - 1;
+const unsigned int infiniteDistance = ~0u;
+
+enum Tree : unsigned char { FREE, SOURCE_TREE, SINK_TREE };
+
+}
+
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::boykovKolmogorov(unsigned int source, unsigned int sink) {
+  if (source >= getNodeCount() || sink >= getNodeCount() || source == sink) {
+    throw(std::runtime_error("boykovKolmogorov: Invalid source or sink."));
+  }
+  this->source = source;
+  this->sink = sink;
+  preflowOnly = false;
+  Trace::Scope run("boykov kolmogorov");
+
+  // Memory of the last run can be reused
+  scratch.reset();
+  ArenaAllocator<unsigned int> alloc(scratch);
+
+  // Tree of every node, the arc to its parent (pointing away from s in the
+  // source tree and towards t in the sink tree), and the distance to the root
+  // with the time of the augmentation at which it was known to be correct
+  ArenaVector<unsigned char> tree(getNodeCount(), FREE, ArenaAllocator<unsigned char>(scratch));
+  ArenaVector<unsigned int> parent(getNodeCount(), noParent, alloc);
+  ArenaVector<unsigned int> dist(getNodeCount(), 0, alloc);
+  ArenaVector<unsigned int> timestamp(getNodeCount(), 0, alloc);
+  unsigned int time = 1;
+
+  FifoQueue active(getNodeCount(), scratch);
+  ArenaVector<unsigned int> orphans(alloc);
+
+  auto from = [this](unsigned int a) { return a % 2 == 0 ? tails[a/2] : heads[a/2]; };
+  auto to = [this](unsigned int a) { return a % 2 == 0 ? heads[a/2] : tails[a/2]; };
+  auto residual = [this](unsigned int a) -> Cap {
+    return a % 2 == 0 ? capacities[a/2] - flows[a/2] : flows[a/2];
+  };
+  // the parent of a node, which has to have a parent arc
+  auto next = [&](unsigned int a) {
+    return tree[a] == SOURCE_TREE ? from(parent[a]) : to(parent[a]);
+  };
+  // true if a is the arc into resp. out of the node in its tree direction
+  auto usable = [&](unsigned int a, unsigned char t) {
+    return t == SOURCE_TREE ? residual(a) > 0 : residual(a^1) > 0;
+  };
+
+  tree[source] = SOURCE_TREE;
+  parent[source] = terminal;
+  tree[sink] = SINK_TREE;
+  parent[sink] = terminal;
+  active.insert(source, 0);
+  active.insert(sink, 0);
+
+  while (true) {
+    // Growth stage: extend the trees until they touch in the arc meet, which
+    // goes from the source tree to the sink tree
+    unsigned int meet = noParent;
+    while (!active.empty() && meet == noParent) {
+      unsigned int v = active.pop();
+      if (tree[v] == FREE) {
+        continue;
+      }
+
+      Node& node = getNode(v);
+      for (unsigned int i = 0; i < node.getOutEdges().size() + node.getInEdges().size() && meet == noParent; i++) {
+        // arcs leaving v
+        unsigned int a = i < node.getOutEdges().size() ? 2*node.getOutEdges()[i]
+          : 2*node.getInEdges()[i - node.getOutEdges().size()] + 1;
+        if (!usable(a, tree[v])) {
+          continue;
+        }
+        unsigned int w = to(a);
+        unsigned int arcToParent = tree[v] == SOURCE_TREE ? a : a^1;
+        if (tree[w] == FREE) {
+          tree[w] = tree[v];
+          parent[w] = arcToParent;
+          timestamp[w] = timestamp[v];
+          dist[w] = dist[v] + 1;
+          if (!active.contains(w)) {
+            active.insert(w, 0);
+          }
+        } else if (tree[w] != tree[v]) {
+          meet = tree[v] == SOURCE_TREE ? a : a^1;
+        } else if (timestamp[w] <= timestamp[v] && dist[w] > dist[v]) {
+          // v is a closer parent for w
+          parent[w] = arcToParent;
+          timestamp[w] = timestamp[v];
+          dist[w] = dist[v] + 1;
+        }
+      }
+
+      // v may have further neighbours in the other tree
+      if (meet != noParent) {
+        active.insert(v, 0);
+      }
+    }
+
+    if (meet == noParent) {
+      break;
+    }
+    time++;
+
+    // Augmentation stage: find the bottleneck of the path and push the flow
+    Cap bottleneck = residual(meet);
+    for (unsigned int v = from(meet); parent[v] != terminal; v = from(parent[v])) {
+      if (residual(parent[v]) < bottleneck) {
+        bottleneck = residual(parent[v]);
+      }
+    }
+    for (unsigned int v = to(meet); parent[v] != terminal; v = to(parent[v])) {
+      if (residual(parent[v]) < bottleneck) {
+        bottleneck = residual(parent[v]);
+      }
+    }
+
+    auto push = [&](unsigned int a) {
+      Edge e = getEdge(a/2);
+      if (a % 2 == 0) {
+        setFlow(e, e.getFlow() + bottleneck);
+      } else {
+        setFlow(e, e.getFlow() - bottleneck);
+      }
+    };
+    push(meet);
+    for (unsigned int v = from(meet); parent[v] != terminal; ) {
+      unsigned int a = parent[v];
+      unsigned int u = from(a);
+      push(a);
+      if (residual(a) == 0) {
+        parent[v] = noParent;
+        orphans.push_back(v);
+      }
+      v = u;
+    }
+    for (unsigned int v = to(meet); parent[v] != terminal; ) {
+      unsigned int a = parent[v];
+      unsigned int u = to(a);
+      push(a);
+      if (residual(a) == 0) {
+        parent[v] = noParent;
+        orphans.push_back(v);
+      }
+      v = u;
+    }
+
+    // Adoption stage: find new parents for the orphans, the new parent has to
+    // be connected to the root of the tree
+    while (!orphans.empty()) {
+      unsigned int v = orphans.back();
+      orphans.pop_back();
+      unsigned char t = tree[v];
+      Node& node = getNode(v);
+      unsigned int edgeCount = node.getOutEdges().size() + node.getInEdges().size();
+
+      unsigned int bestArc = noParent;
+      unsigned int bestDist = infiniteDistance;
+      for (unsigned int i = 0; i < edgeCount; i++) {
+        unsigned int a = i < node.getOutEdges().size() ? 2*node.getOutEdges()[i]
+          : 2*node.getInEdges()[i - node.getOutEdges().size()] + 1;
+        unsigned int w = to(a);
+        // the arc from w to v (source tree) resp. from v to w (sink tree)
+        // becomes the parent arc
+        unsigned int arcToParent = t == SOURCE_TREE ? a^1 : a;
+        if (tree[w] != t || residual(arcToParent) == 0) {
+          continue;
+        }
+
+        // Distance of w to the root, infinite if w is cut off from it
+        unsigned int d = 0;
+        unsigned int j = w;
+        while (true) {
+          if (timestamp[j] == time) {
+            d += dist[j];
+            break;
+          }
+          if (parent[j] == terminal) {
+            timestamp[j] = time;
+            dist[j] = 0;
+            break;
+          }
+          if (parent[j] == noParent) {
+            d = infiniteDistance;
+            break;
+          }
+          d++;
+          j = next(j);
+        }
+        if (d == infiniteDistance) {
+          continue;
+        }
+
+        if (d < bestDist) {
+          bestArc = arcToParent;
+          bestDist = d;
+        }
+        // the distances on the path are correct now
+        for (j = w; timestamp[j] != time; j = next(j)) {
+          timestamp[j] = time;
+          dist[j] = d;
+          d--;
+        }
+      }
+
+      if (bestArc != noParent) {
+        parent[v] = bestArc;
+        timestamp[v] = time;
+        dist[v] = bestDist + 1;
+        continue;
+      }
+
+      // No parent found, v is freed. Its neighbours in the tree may reach it
+      // again later, so they become active, and its children become orphans.
+      for (unsigned int i = 0; i < edgeCount; i++) {
+        unsigned int a = i < node.getOutEdges().size() ? 2*node.getOutEdges()[i]
+          : 2*node.getInEdges()[i - node.getOutEdges().size()] + 1;
+        unsigned int w = to(a);
+        if (tree[w] != t) {
+          continue;
+        }
+        if (residual(t == SOURCE_TREE ? a^1 : a) > 0 && !active.contains(w)) {
+          active.insert(w, 0);
+        }
+        if (parent[w] != noParent && parent[w] != terminal && next(w) == v) {
+          parent[w] = noParent;
+          orphans.push_back(w);
+        }
+      }
+      tree[v] = FREE;
+    }
+  }
+}
+
+// Boykov-Kolmogorov algorithm with s = 0 and t = 1
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::boykovKolmogorov() {
+  boykovKolmogorov(0, 1);
+}
+
+template void BasicGraph<unsigned short int, unsigned int>::boykovKolmogorov();
+template void BasicGraph<unsigned short int, unsigned long long int>::boykovKolmogorov();
+template void BasicGraph<unsigned int, unsigned int>::boykovKolmogorov();
+template void BasicGraph<unsigned int, unsigned long long int>::boykovKolmogorov();
+template void BasicGraph<unsigned long long int, unsigned long long int>::boykovKolmogorov();
+template void BasicGraph<unsigned short int, unsigned int>::boykovKolmogorov(unsigned int, unsigned int);
+template void BasicGraph<unsigned short int, unsigned long long int>::boykovKolmogorov(unsigned int, unsigned int);
+template void BasicGraph<unsigned int, unsigned int>::boykovKolmogorov(unsigned int, unsigned int);
+template void BasicGraph<unsigned int, unsigned long long int>::boykovKolmogorov(unsigned int, unsigned int);
+template void BasicGraph<unsigned long long int, unsigned long long int>::boykovKolmogorov(unsigned int, unsigned int);
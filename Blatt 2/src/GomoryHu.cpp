@@ -0,0 +1,165 @@
+#include <vector>
+#include <thread>
+#include <memory>
+#include <algorithm>
+#include "GomoryHu.h"
+#include "Writer.h"
+
+// Result of one maximum flow computation of Gusfield's algorithm
+struct CutResult {
+  unsigned int sink;
+  unsigned long long int value;
+  std::vector<bool> sourceSide;
+};
+
+// Builds the undirected version of g. Its node flow sums can be twice as large
+// as in g, so they are always summed up in 64 bit.
+template <typename Cap, typename Flow>
+static BasicGraph<Cap, unsigned long long int>* undirectedCopy(BasicGraph<Cap, Flow>& g) {
+  BasicGraph<Cap, unsigned long long int>* res = new BasicGraph<Cap, unsigned long long int>(g.getNodeCount());
+  auto tails = g.getTails();
+  auto heads = g.getHeads();
+  auto capacities = g.getCapacities();
+  for (unsigned int e = 0; e < g.getEdgeCount(); e++) {
+    res->addEdge(tails[e], heads[e], capacities[e]);
+    res->addEdge(heads[e], tails[e], capacities[e]);
+  }
+  return res;
+}
+
+// Computes a minimum cut between source and sink on the given graph
+template <typename G>
+static void computeCut(G& g, unsigned int source, unsigned int sink, CutResult& res) {
+  g.resetFlow();
+  g.pushRelabel(source, sink, true);
+
+  std::vector<unsigned int> sourceSide;
+  std::vector<unsigned int> cutEdges;
+  g.minCut(sourceSide, cutEdges);
+
+  res.sink = sink;
+  res.value = g.getFlowValue();
+  res.sourceSide.assign(g.getNodeCount(), false);
+  for (unsigned int n : sourceSide) {
+    res.sourceSide[n] = true;
+  }
+}
+
+// Builds the tree. The maximum flow computations are done in batches of
+// threadCount, every thread works on its own copy of the graph. A computation
+// for node i uses the parent of i at the start of the batch; if an earlier
+// node of the batch changed that parent, the computation is repeated. The
+// minimum cut with the largest source side is unique, so the result is the
+// same as with sequential computations.
+template <typename Cap, typename Flow>
+GomoryHuTree::GomoryHuTree(BasicGraph<Cap, Flow>& g, unsigned int threadCount) {
+  typedef BasicGraph<Cap, unsigned long long int> Copy;
+
+  nodeCount = g.getNodeCount();
+  parent.assign(nodeCount, 0);
+  value.assign(nodeCount, 0);
+  depth.assign(nodeCount, 0);
+
+  if (threadCount == 0) {
+    threadCount = 1;
+  }
+  if (nodeCount > 1 && threadCount > nodeCount-1) {
+    threadCount = nodeCount-1;
+  }
+
+  std::vector<std::unique_ptr<Copy>> copies;
+  for (unsigned int i = 0; i < threadCount && nodeCount > 1; i++) {
+    copies.push_back(std::unique_ptr<Copy>(undirectedCopy(g)));
+  }
+
+  std::vector<CutResult> results(threadCount);
+  for (unsigned int next = 1; next < nodeCount; next += threadCount) {
+    unsigned int batch = std::min(threadCount, nodeCount - next);
+
+    // Compute the cuts of the batch in parallel
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < batch; t++) {
+      threads.push_back(std::thread(computeCut<Copy>, std::ref(*copies[t]), next+t, parent[next+t], std::ref(results[t])));
+    }
+    computeCut(*copies[0], next, parent[next], results[0]);
+    for (std::thread& t : threads) {
+      t.join();
+    }
+
+    // Apply the cuts in order
+    for (unsigned int t = 0; t < batch; t++) {
+      unsigned int i = next + t;
+      if (results[t].sink != parent[i]) {
+        computeCut(*copies[0], i, parent[i], results[t]);
+      }
+
+      value[i] = results[t].value;
+      for (unsigned int j = i+1; j < nodeCount; j++) {
+        if (results[t].sourceSide[j] && parent[j] == parent[i]) {
+          parent[j] = i;
+        }
+      }
+    }
+  }
+
+  // Every node has a parent with a smaller id, so depths can be set in order
+  for (unsigned int i = 1; i < nodeCount; i++) {
+    depth[i] = depth[parent[i]] + 1;
+  }
+}
+
+// Gets the node count of the tree
+unsigned int GomoryHuTree::getNodeCount() {
+  return nodeCount;
+}
+
+// Gets the parent of a node, the root 0 is its own parent
+unsigned int GomoryHuTree::getParent(unsigned int a) {
+  return parent[a];
+}
+
+// Gets the value of the tree edge from a to its parent
+unsigned long long int GomoryHuTree::getValue(unsigned int a) {
+  return value[a];
+}
+
+// Gets the minimum cut value between a and b, which is the smallest value on
+// the tree path between them
+unsigned long long int GomoryHuTree::minCutValue(unsigned int a, unsigned int b) {
+  if (a >= nodeCount || b >= nodeCount) {
+    throw(std::runtime_error("Tried to get the cut value of a non-existing node."));
+  }
+
+  unsigned long long int res = ~0ULL;
+  while (a != b) {
+    if (depth[a] < depth[b]) {
+      std::swap(a, b);
+    }
+    res = std::min(res, value[a]);
+    a = parent[a];
+  }
+  return res;
+}
+
+// Exports the tree: the node count, then one line "node parent value" for
+// every node except the root
+void GomoryHuTree::exportTree(std::ostream& out) {
+  Writer w(out);
+  w.writeUInt(nodeCount);
+  w.writeChar('\n');
+  for (unsigned int i = 1; i < nodeCount; i++) {
+    w.writeUInt(i);
+    w.writeChar(' ');
+    w.writeUInt(parent[i]);
+    w.writeChar(' ');
+    w.writeUInt(value[i]);
+    w.writeChar('\n');
+  }
+}
+
+// Instantiations for all graph types
+template GomoryHuTree::GomoryHuTree(BasicGraph<unsigned short int, unsigned int>& g, unsigned int threadCount);
+template GomoryHuTree::GomoryHuTree(BasicGraph<unsigned short int, unsigned long long int>& g, unsigned int threadCount);
+template GomoryHuTree::GomoryHuTree(BasicGraph<unsigned int, unsigned int>& g, unsigned int threadCount);
+template GomoryHuTree::GomoryHuTree(BasicGraph<unsigned int, unsigned long long int>& g, unsigned int threadCount);
+template GomoryHuTree::GomoryHuTree(BasicGraph<unsigned long long int, unsigned long long int>& g, unsigned int threadCount);
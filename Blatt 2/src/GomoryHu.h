@@ -0,0 +1,29 @@
+#ifndef GOMORYHU_H
+#define GOMORYHU_H
+
+#include <vector>
+#include <iostream>
+#include "Graph.h"
+
+// Gomory-Hu tree of the undirected version of a graph (every edge can be used
+// in both directions with its capacity), built with Gusfield's algorithm.
+// The minimum cut value between two nodes is the smallest value on the path
+// between them in the tree.
+class GomoryHuTree {
+public:
+  template <typename Cap, typename Flow>
+  GomoryHuTree(BasicGraph<Cap, Flow>& g, unsigned int threadCount);
+  unsigned int getNodeCount();
+  unsigned int getParent(unsigned int a);
+  unsigned long long int getValue(unsigned int a);
+  unsigned long long int minCutValue(unsigned int a, unsigned int b);
+  void exportTree(std::ostream& out);
+private:
+  unsigned int nodeCount;
+  // The tree is rooted at node 0, value[a] belongs to the edge {a, parent[a]}
+  std::vector<unsigned int> parent;
+  std::vector<unsigned long long int> value;
+  std::vector<unsigned int> depth;
+};
+
+#endif
@@ -3,41 +3,54 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
 #include "Graph.h"
-
-Graph::Edge::Edge(unsigned int a, unsigned int b, unsigned int capacity, unsigned int id) {
+#include "Simd.h"
+#include "Arena.h"
+#include "ActiveNodes.h"
+#include "Writer.h"
+#include "Trace.h"
+
+template <typename Cap, typename Flow>
+BasicGraph<Cap, Flow>::Edge::Edge(BasicGraph* g, unsigned int id) {
+  this->g = g;
   this->id = id;
-  this->a = a;
-  this->b = b;
-  this->capacity = capacity;
 }
 
-unsigned int Graph::Edge::getId() {
+template <typename Cap, typename Flow>
+unsigned int BasicGraph<Cap, Flow>::Edge::getId() {
   return id;
 }
 
-unsigned int Graph::Edge::getA() {
-  return a;
+template <typename Cap, typename Flow>
+unsigned int BasicGraph<Cap, Flow>::Edge::getA() {
+  return g->tails[id];
 }
 
-unsigned int Graph::Edge::getB() {
-  return b;
+template <typename Cap, typename Flow>
+unsigned int BasicGraph<Cap, Flow>::Edge::getB() {
+  return g->heads[id];
 }
 
-unsigned int Graph::Edge::getCapacity() {
-  return capacity;
+template <typename Cap, typename Flow>
+Cap BasicGraph<Cap, Flow>::Edge::getCapacity() {
+  return g->capacities[id];
 }
 
-unsigned int Graph::Edge::getFlow() {
-  return flow;
+template <typename Cap, typename Flow>
+Cap BasicGraph<Cap, Flow>::Edge::getFlow() {
+  return g->flows[id];
 }
 
-void Graph::setFlow(Edge& e, unsigned int fl) {
-  unsigned int oldflow = e.getFlow();
-  e.flow = fl;
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::setFlow(Edge e, Cap fl) {
+  Cap oldflow = flows[e.getId()];
+  flows[e.getId()] = fl;
 
-  Node& a = getNode(e.getA());
-  Node& b = getNode(e.getB());
+  Node& a = getNode(tails[e.getId()]);
+  Node& b = getNode(heads[e.getId()]);
 
   a.outFlow -= oldflow;
   a.outFlow += fl;
@@ -45,104 +58,132 @@ void Graph::setFlow(Edge& e, unsigned int fl) {
   b.inFlow += fl;
 }
 
-Graph::Node::Node(unsigned int id) {
+template <typename Cap, typename Flow>
+BasicGraph<Cap, Flow>::Node::Node(unsigned int id, Arena& arena) : inEdges(ArenaAllocator<unsigned int>(arena)), outEdges(ArenaAllocator<unsigned int>(arena)) {
   this->id = id;
 }
 
-unsigned int Graph::Node::getId() {
+template <typename Cap, typename Flow>
+unsigned int BasicGraph<Cap, Flow>::Node::getId() {
   return id;
 }
 
-void Graph::addOutEdge(Graph::Node& n, unsigned int e) {
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::addOutEdge(Node& n, unsigned int e) {
   n.outEdges.push_back(e);
-  n.outFlow += getEdge(e).getFlow();
+  n.outFlow += flows[e];
 }
 
-void Graph::addInEdge(Graph::Node& n, unsigned int e) {
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::addInEdge(Node& n, unsigned int e) {
   n.inEdges.push_back(e);
-  n.inFlow += getEdge(e).getFlow();
+  n.inFlow += flows[e];
 }
 
 // Gets the edges going out
-std::vector<unsigned int>& Graph::Node::getOutEdges() {
+template <typename Cap, typename Flow>
+typename BasicGraph<Cap, Flow>::EdgeList& BasicGraph<Cap, Flow>::Node::getOutEdges() {
   return outEdges;
 }
 
 // Gets the edges going in
-std::vector<unsigned int>& Graph::Node::getInEdges() {
+template <typename Cap, typename Flow>
+typename BasicGraph<Cap, Flow>::EdgeList& BasicGraph<Cap, Flow>::Node::getInEdges() {
   return inEdges;
 }
 
 // Gets the flow out of the edge
-unsigned long long int Graph::Node::getOutFlow() {
+template <typename Cap, typename Flow>
+Flow BasicGraph<Cap, Flow>::Node::getOutFlow() {
   return outFlow;
 }
 
 // Gets the flow into the edge
-unsigned long long int Graph::Node::getInFlow() {
+template <typename Cap, typename Flow>
+Flow BasicGraph<Cap, Flow>::Node::getInFlow() {
   return inFlow;
 }
 
-// Constructor, initializes the graph
-Graph::Graph(unsigned int nc) {
+// Adds the node objects and the padding of the edge arrays
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::initNodes(unsigned int nc) {
   nodeCount = nc;
 
   // Add node objects to nodes vector
   nodes.reserve(nc);
   for (unsigned int i = 0; i < nc; i++) {
-    nodes.push_back(Node(i));
+    nodes.push_back(Node(i, graphArena));
   }
+
+  capacities.push_back(0);
+  flows.push_back(0);
 }
 
-// Parses a graph file and constructs the graph
-Graph::Graph(std::string filename) {
-  std::fstream file(filename, std::ios_base::in);
+// Constructor, initializes the graph
+template <typename Cap, typename Flow>
+BasicGraph<Cap, Flow>::BasicGraph(unsigned int nc) {
+  initNodes(nc);
+}
 
-  // Check if file is open
-  if (!file.is_open()) {
-    nodeCount = 0;
-    throw(std::runtime_error("File could not be opened."));
-    return;
+// Parses a graph file and constructs the graph
+template <typename Cap, typename Flow>
+BasicGraph<Cap, Flow>::BasicGraph(std::string filename) {
+  Instance instance(filename);
+  initNodes(instance.getNodeCount());
+  for (unsigned int e = 0; e < instance.getEdgeCount(); e++) {
+    addEdge(instance.getTail(e), instance.getHead(e), instance.getCapacity(e));
   }
+}
 
-  // Set Node Count of the Graph
-  unsigned int nc;
-  file >> nc;
-  nodeCount = nc;
-
-  // Add node objects to nodes vector
-  nodes.reserve(nc);
-  for (unsigned int i = 0; i < nc; i++) {
-    nodes.push_back(Node(i));
+// Constructs the graph of an instance, which has to fit into the capacity
+// types of the graph
+template <typename Cap, typename Flow>
+BasicGraph<Cap, Flow>::BasicGraph(Instance& instance) {
+  if (instance.getMaxCapacity() > std::numeric_limits<Cap>::max() ||
+    instance.getMaxNodeCapacity() > std::numeric_limits<Flow>::max()) {
+    throw(std::runtime_error("The capacities of the instance are too large for the graph."));
   }
 
-  // Parses edges from the file
-  unsigned int a, b, capacity;
-  while (file >> a >> b >> capacity) {
-    addEdge(a, b, capacity);
+  initNodes(instance.getNodeCount());
+  tails.reserve(instance.getEdgeCount());
+  heads.reserve(instance.getEdgeCount());
+  capacities.reserve(instance.getEdgeCount() + 1);
+  flows.reserve(instance.getEdgeCount() + 1);
+  for (unsigned int e = 0; e < instance.getEdgeCount(); e++) {
+    addEdge(instance.getTail(e), instance.getHead(e), instance.getCapacity(e));
   }
 }
 
 // Adds an edge to the graph
-void Graph::addEdge(unsigned int a, unsigned int b, unsigned int capacity) {
-  Edge e(a, b, capacity, edges.size());
-  edges.push_back(e);
-  addOutEdge(getNode(a), e.getId());
-  addInEdge(getNode(b), e.getId());
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::addEdge(unsigned int a, unsigned int b, Cap capacity) {
+  unsigned int id = getEdgeCount();
+  tails.push_back(a);
+  heads.push_back(b);
+  // the last element is the padding
+  capacities.back() = capacity;
+  capacities.push_back(0);
+  flows.back() = 0;
+  flows.push_back(0);
+  addOutEdge(getNode(a), id);
+  addInEdge(getNode(b), id);
 }
 
 // Gets the node count of the graph
-unsigned int Graph::getNodeCount() {
+template <typename Cap, typename Flow>
+unsigned int BasicGraph<Cap, Flow>::getNodeCount() {
   return nodeCount;
 }
 
 // Gets the edge count of the graph
-unsigned int Graph::getEdgeCount() {
-  return edges.size();
+template <typename Cap, typename Flow>
+unsigned int BasicGraph<Cap, Flow>::getEdgeCount() {
+  return tails.size();
 }
 
 // Gets a node in the graph
-Graph::Node& Graph::getNode(unsigned int a) {
+template <typename Cap, typename Flow>
+typename BasicGraph<Cap, Flow>::Node& BasicGraph<Cap, Flow>::getNode(unsigned int a) {
   if (a > getNodeCount()) {
     throw(std::runtime_error("Tried to get non-existing node."));
   }
@@ -150,195 +191,543 @@ Graph::Node& Graph::getNode(unsigned int a) {
 }
 
 // Gets an edge in the graph
-Graph::Edge& Graph::getEdge(unsigned int a) {
+template <typename Cap, typename Flow>
+typename BasicGraph<Cap, Flow>::Edge BasicGraph<Cap, Flow>::getEdge(unsigned int a) {
   if (a > getEdgeCount()) {
     throw(std::runtime_error("Tried to get non-existing edge."));
   }
-  return edges[a];
+  return Edge(this, a);
+}
+
+// Gets the tail nodes of all edges, indexed by edge id
+template <typename Cap, typename Flow>
+typename BasicGraph<Cap, Flow>::template ArrayView<unsigned int> BasicGraph<Cap, Flow>::getTails() {
+  return ArrayView<unsigned int>(tails.data(), tails.size());
+}
+
+// Gets the head nodes of all edges, indexed by edge id
+template <typename Cap, typename Flow>
+typename BasicGraph<Cap, Flow>::template ArrayView<unsigned int> BasicGraph<Cap, Flow>::getHeads() {
+  return ArrayView<unsigned int>(heads.data(), heads.size());
+}
+
+// Gets the capacities of all edges, indexed by edge id
+template <typename Cap, typename Flow>
+typename BasicGraph<Cap, Flow>::template ArrayView<Cap> BasicGraph<Cap, Flow>::getCapacities() {
+  return ArrayView<Cap>(capacities.data(), getEdgeCount());
+}
+
+// Gets the flow values of all edges, indexed by edge id
+template <typename Cap, typename Flow>
+typename BasicGraph<Cap, Flow>::template ArrayView<Cap> BasicGraph<Cap, Flow>::getFlows() {
+  return ArrayView<Cap>(flows.data(), getEdgeCount());
 }
 
 // Push Relabel help functions:
 
+// Solver state, all of it is allocated from the scratch arena of the graph
+typedef ArenaVector<unsigned int> LabelArray;
+typedef ArenaVector<ArenaList<unsigned int>> ListArray;
+
 // finds the minimum label of a neighboured node
-unsigned int findMinimumLabel(std::vector<unsigned int> labels, Graph& g, Graph::Node& active) {
+template <typename G>
+unsigned int findMinimumLabel(LabelArray& labels, G& g, typename G::Node& active) {
   unsigned int minimumLabel = 2*g.getNodeCount(); // will be made smaller
 
-  // search minimum label adjacent to the node in residual graph
-  for (unsigned int e : active.getOutEdges()) {
-    // Check if the edge is in the residual graph
-    if (g.getEdge(e).getFlow() < g.getEdge(e).getCapacity()) {
-      // Is the label smaller than the ones found?
-      if (labels[g.getEdge(e).getB()] < minimumLabel) {
-        minimumLabel = labels[g.getEdge(e).getB()];
-      }
-    }
-  }
-  for (unsigned int e : active.getInEdges()) {
-    // Check if the edge is in the residual graph
-    if (g.getEdge(e).getFlow() > 0) {
-      // Is the label smaller than the ones found?
-      if (labels[g.getEdge(e).getA()] < minimumLabel) {
-        minimumLabel = labels[g.getEdge(e).getA()];
-      }
-    }
-  }
+  // search minimum label adjacent to the node in residual graph, an out edge is
+  // residual if it is not saturated, an in edge if it has flow
+  typename G::EdgeList& out = active.getOutEdges();
+  typename G::EdgeList& in = active.getInEdges();
+  minimumLabel = minResidualLabel(out.data(), out.size(), g.getHeads().data(), g.getFlows().data(),
+    g.getCapacities().data(), labels.data(), minimumLabel);
+  minimumLabel = minResidualLabel<typename G::CapacityType>(in.data(), in.size(), g.getTails().data(), g.getFlows().data(),
+    nullptr, labels.data(), minimumLabel);
 
   return minimumLabel;
 }
 
 // updates the list of allowed edges for a node
-void updateAllowedEdges(std::vector<std::list<unsigned int>>& allowedEdges, std::vector<unsigned int>& labels, Graph& g, Graph::Node& active) {
+template <typename G>
+void updateAllowedEdges(ListArray& allowedEdges, LabelArray& labels, ArenaVector<unsigned int>& buffer, G& g, typename G::Node& active) {
   // clear the list
   allowedEdges[active.getId()].clear();
 
-  for (unsigned int e : active.getOutEdges()) {
-    // Check if the edge is in the residual graph
-    if (g.getEdge(e).getFlow() < g.getEdge(e).getCapacity()) {
-      // check if the edge is allowed
-      if (labels[active.getId()] == labels[g.getEdge(e).getB()]+1) {
-        allowedEdges[active.getId()].push_back(e);
-      }
-    }
+  // an edge is allowed if it is residual and its end node has a label one less
+  // than the active node
+  if (labels[active.getId()] == 0) {
+    return;
   }
-  for (unsigned int e : active.getInEdges()) {
-    // Check if the edge is in the residual graph
-    if (g.getEdge(e).getFlow() > 0) {
-      // Check if the edge is allowed
-      if (labels[active.getId()] == labels[g.getEdge(e).getA()]+1) {
-        allowedEdges[active.getId()].push_back(e);
-      }
+  unsigned int target = labels[active.getId()] - 1;
+
+  typename G::EdgeList& out = active.getOutEdges();
+  typename G::EdgeList& in = active.getInEdges();
+  buffer.resize(out.size() + in.size());
+  unsigned int found = collectAllowedEdges(out.data(), out.size(), g.getHeads().data(), g.getFlows().data(),
+    g.getCapacities().data(), labels.data(), target, buffer.data());
+  found += collectAllowedEdges<typename G::CapacityType>(in.data(), in.size(), g.getTails().data(), g.getFlows().data(),
+    nullptr, labels.data(), target, buffer.data() + found);
+
+  allowedEdges[active.getId()].insert(allowedEdges[active.getId()].end(), buffer.begin(), buffer.begin() + found);
+}
+
+// Relabels are traced in bursts, every thread of the Gomory-Hu tree has its
+// own counter
+thread_local Trace::Burst relabelBurst("relabel burst", 1024);
+
+// relabels the active node and updates its allowed edges
+template <typename G>
+void relabel(ListArray& allowedEdges, LabelArray& labels, ArenaVector<unsigned int>& buffer, G& g, typename G::Node& active) {
+  relabelBurst.tick();
+  labels[active.getId()] = findMinimumLabel(labels, g, active) + 1;
+
+  // Incoming edges in the residual graph may have become not allowed because
+  // of the increased label of the active note. Therefore, it has to be checked,
+  // whether an edge in the allowedEdges ist really is allowed!
+  updateAllowedEdges(allowedEdges, labels, buffer, g, active);
+}
+
+// finds the first edge of the allowed edge list which is really allowed, see
+// the comment in relabel. Edges which are not allowed any more are removed.
+// Returns false if there is no allowed edge.
+template <typename G>
+bool firstAllowedEdge(ListArray& allowedEdges, LabelArray& labels, G& g, typename G::Node& active, unsigned int& res) {
+  ArenaList<unsigned int>& list = allowedEdges[active.getId()];
+  while (!list.empty()) {
+    typename G::Edge allowed = g.getEdge(list.front());
+    unsigned int other = active.getId() == allowed.getA() ? allowed.getB() : allowed.getA();
+    if (labels[active.getId()] == labels[other]+1) {
+      res = list.front();
+      return true;
     }
+    list.pop_front();
   }
+  return false;
 }
 
-// pushes the flow along an allowed edge
-void pushAllowedEdge(std::vector<std::list<unsigned int>>& allowedEdges, std::vector<unsigned int>& labels, std::vector<std::list<unsigned int>>& labelBucket, unsigned int maxLabel, Graph& g, Graph::Node& active, Graph::Edge& allowed) {
-  // The excess of the active node
-  unsigned long long int excess = active.getInFlow() - active.getOutFlow();
+// pushes at most amount units of flow from the active node along an allowed
+// edge and returns the node on the other side
+template <typename G>
+unsigned int pushAllowedEdge(ListArray& allowedEdges, G& g, typename G::Node& active, typename G::Edge allowed,
+  typename G::FlowType amount) {
+  typedef typename G::CapacityType Cap;
 
   // Which kind of residual edge?
   if (active.getId() == allowed.getA()) {
-    // Is the push saturating? Has the active state to be updated?
-    if (excess > allowed.getCapacity()-allowed.getFlow()) {
-      g.setFlow(allowed, allowed.getCapacity());
-      // The edge does not exist any more in the residual graph
+    Cap residual = allowed.getCapacity() - allowed.getFlow();
+    Cap delta = amount < residual ? static_cast<Cap>(amount) : residual;
+    g.setFlow(allowed, allowed.getFlow() + delta);
+    // The edge does not exist any more in the residual graph
+    if (delta == residual) {
       allowedEdges[active.getId()].pop_front();
-    } else {
-      g.setFlow(allowed, allowed.getFlow() + excess);
-      // The node is no longer active
-      labelBucket[maxLabel].pop_front();
-      if (excess == allowed.getCapacity()-allowed.getFlow()) {
-        allowedEdges[active.getId()].pop_front();
-      }
-    }
-    // We created a new active node if allowed is not connected to t
-    if (allowed.getB() > 1) {
-      labelBucket[labels[allowed.getB()]].push_back(allowed.getB());
     }
+    return allowed.getB();
   } else {
-    // Is the push saturating? Has the active state to be updated?
-    if (excess > allowed.getFlow()) {
-      g.setFlow(allowed, 0);
-      // The edge does not exist any more in the residual graph
+    Cap residual = allowed.getFlow();
+    Cap delta = amount < residual ? static_cast<Cap>(amount) : residual;
+    g.setFlow(allowed, allowed.getFlow() - delta);
+    // The edge does not exist any more in the residual graph
+    if (delta == residual) {
       allowedEdges[active.getId()].pop_front();
-    } else {
-      g.setFlow(allowed, allowed.getFlow() - excess);
-      // The node is no longer active
-      labelBucket[maxLabel].pop_front();
-      if (excess == allowed.getFlow()) {
-        allowedEdges[active.getId()].pop_front();
+    }
+    return allowed.getA();
+  }
+}
+
+// Pushes the excess of the active node along allowed edges and relabels it
+// until it is no longer active. Nodes which become active are inserted into
+// the selection. If valueOnly is set, the node is given up as soon as its label
+// reaches the node count.
+template <typename G, typename Selection>
+void discharge(ListArray& allowedEdges, LabelArray& labels, ArenaVector<unsigned int>& buffer, Selection& selection,
+  bool valueOnly, unsigned int source, unsigned int sink, G& g, typename G::Node& active) {
+  while (active.getInFlow() != active.getOutFlow()) {
+    unsigned int e;
+    if (!firstAllowedEdge(allowedEdges, labels, g, active, e)) {
+      relabel(allowedEdges, labels, buffer, g, active);
+      if (valueOnly && labels[active.getId()] >= g.getNodeCount()) {
+        return;
       }
+      continue;
     }
-    // We created a new active node if allowed is not connected to t
-    if (allowed.getA() > 1) {
-      labelBucket[labels[allowed.getA()]].push_back(allowed.getA());
+
+    unsigned int other = pushAllowedEdge(allowedEdges, g, active, g.getEdge(e), active.getInFlow() - active.getOutFlow());
+    // We created a new active node if the edge is not connected to s or t
+    if (other != source && other != sink && !selection.contains(other)) {
+      selection.insert(other, labels[other]);
     }
   }
 }
 
-// Push relabel algorithm
-void Graph::pushRelabel() {
-  // Maps a node id to a label
-  std::vector<unsigned int> labels(getNodeCount());
-  labels[0] = getNodeCount();
-
-  // Stores allowed edges in the residual graph for each node
-  std::vector<std::list<unsigned int>> allowedEdges(getNodeCount());
+// Discharges active nodes in the order of the selection until there are none
+template <typename G, typename Selection>
+void dischargeAll(ListArray& allowedEdges, LabelArray& labels, ArenaVector<unsigned int>& buffer, Selection& selection,
+  bool valueOnly, unsigned int source, unsigned int sink, G& g) {
+  while (!selection.empty()) {
+    typename G::Node& active = g.getNode(selection.pop());
 
-  // Bucket for active nodes with the same label value
-  unsigned int maxLabel = 0;
-  std::vector<std::list<unsigned int>> labelBucket(2*getNodeCount()-1);
+    // Nodes with such labels cannot reach t any more, their excess would only
+    // be sent back to s
+    if (valueOnly && labels[active.getId()] >= g.getNodeCount()) {
+      continue;
+    }
 
-  Node &s = getNode(0);
+    discharge(allowedEdges, labels, buffer, selection, valueOnly, source, sink, g, active);
+  }
+}
 
-  // Maximize flow of edges adjacent to s and store their heads as active nodes
-  for (unsigned int e : s.getOutEdges()) {
-    setFlow(getEdge(e), getEdge(e).getCapacity());
-    if (getEdge(e).getFlow() > 0 && getEdge(e).getB() > 1) {
-      labelBucket[0].push_back(getEdge(e).getB());
+// Excess scaling: in a phase with the bound delta, every node has an excess of
+// at most delta. Nodes with an excess of more than delta/2 are large, the large
+// node with the lowest label does one push or relabel. Pushes into other nodes
+// than s and t are limited, so that their excess stays at most delta. The bound
+// is halved when there are no large nodes left.
+template <typename G>
+void excessScaling(ListArray& allowedEdges, LabelArray& labels, ArenaVector<unsigned int>& buffer, LabelBuckets& large,
+  bool valueOnly, unsigned int source, unsigned int sink, G& g) {
+  typedef typename G::FlowType Flow;
+
+  // the excess of a node other than s
+  auto excess = [&g](unsigned int a) -> Flow {
+    return g.getNode(a).getInFlow() - g.getNode(a).getOutFlow();
+  };
+  // nodes which are given up in valueOnly mode are never large
+  auto isLarge = [&](unsigned int a, Flow delta) {
+    if (a == source || a == sink || (valueOnly && labels[a] >= g.getNodeCount())) {
+      return false;
+    }
+    Flow e = excess(a);
+    return e > delta - e;
+  };
+
+  Flow delta = 0;
+  for (unsigned int a = 0; a < g.getNodeCount(); a++) {
+    if (a != source && a != sink && excess(a) > delta) {
+      delta = excess(a);
     }
   }
 
-  // While we have active nodes
-  while(maxLabel != 0 || !(labelBucket[0].empty())) {
-    if (labelBucket[maxLabel].empty()) {
-      maxLabel--;
-      continue;
+  for (; delta > 0; delta /= 2) {
+    Trace::Scope phase("excess scaling phase");
+    for (unsigned int a = 0; a < g.getNodeCount(); a++) {
+      if (isLarge(a, delta)) {
+        large.insert(a, labels[a]);
+      }
     }
 
-    // Get the active node
-    Node& active = getNode(labelBucket[maxLabel].front());
-    if (active.getInFlow() == active.getOutFlow()) {
-      labelBucket[maxLabel].pop_front();
-      continue;
+    while (!large.empty()) {
+      typename G::Node& active = g.getNode(large.popLowest());
+
+      unsigned int e;
+      if (!firstAllowedEdge(allowedEdges, labels, g, active, e)) {
+        relabel(allowedEdges, labels, buffer, g, active);
+      } else {
+        typename G::Edge allowed = g.getEdge(e);
+        unsigned int other = active.getId() == allowed.getA() ? allowed.getB() : allowed.getA();
+        Flow amount = excess(active.getId());
+        if (other != source && other != sink && delta - excess(other) < amount) {
+          amount = delta - excess(other);
+        }
+        pushAllowedEdge(allowedEdges, g, active, allowed, amount);
+        if (!large.contains(other) && isLarge(other, delta)) {
+          large.insert(other, labels[other]);
+        }
+      }
+
+      if (isLarge(active.getId(), delta)) {
+        large.insert(active.getId(), labels[active.getId()]);
+      }
     }
+  }
+}
 
-    if (allowedEdges[active.getId()].empty()) {
-      // relabel has to be done
-      unsigned int minimumLabel = findMinimumLabel(labels, *this, active);
+// Push relabel algorithm
+// If valueOnly is set, nodes are only processed while their label is smaller
+// than the node count. The result is a maximum preflow: the flow value and the
+// minimum cut are correct, but the flow of the edges is not a valid flow.
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::pushRelabel(unsigned int source, unsigned int sink, bool valueOnly) {
+  if (source >= getNodeCount() || sink >= getNodeCount() || source == sink) {
+    throw(std::runtime_error("pushRelabel: Invalid source or sink."));
+  }
+  this->source = source;
+  this->sink = sink;
+  preflowOnly = valueOnly;
+  Trace::Scope run("push relabel");
 
-      // Update label of the active node
-      labels[active.getId()] = minimumLabel + 1;
+  // Memory of the last run can be reused
+  scratch.reset();
+  ArenaAllocator<unsigned int> alloc(scratch);
+  ArenaList<unsigned int> emptyList(alloc);
 
-      // Update list of allowed edges
-      // Incoming edges in the residual graph may have become not allowed because
-      // of the increased label of the active note. Therefore, it has to be checked,
-      // whether an edge in the allowedEdges ist really is allowed!
-      updateAllowedEdges(allowedEdges, labels, *this, active);
+  // Maps a node id to a label
+  LabelArray labels(getNodeCount(), 0, alloc);
+  labels[source] = getNodeCount();
 
-      // Label bucket has to be updated
+  // Stores allowed edges in the residual graph for each node
+  ListArray allowedEdges(getNodeCount(), emptyList, alloc);
+  ArenaVector<unsigned int> allowedBuffer(alloc);
 
-      // Delete first item of the old bucket
-      labelBucket[maxLabel].pop_front();
+  // Maximize flow of edges adjacent to s, their heads become active
+  Trace::Scope saturation("initial saturation");
+  ArenaVector<unsigned int> initial(alloc);
+  for (unsigned int e : getNode(source).getOutEdges()) {
+    setFlow(getEdge(e), getEdge(e).getCapacity());
+    if (getEdge(e).getFlow() > 0 && getEdge(e).getB() != source && getEdge(e).getB() != sink) {
+      initial.push_back(getEdge(e).getB());
+    }
+  }
+  saturation.end();
+
+  // Labels are at most 2n-1
+  if (selection == FIFO) {
+    FifoQueue queue(getNodeCount(), scratch);
+    for (unsigned int a : initial) {
+      if (!queue.contains(a)) {
+        queue.insert(a, 0);
+      }
+    }
+    dischargeAll(allowedEdges, labels, allowedBuffer, queue, valueOnly, source, sink, *this);
+  } else if (selection == EXCESS_SCALING) {
+    LabelBuckets large(getNodeCount(), 2*getNodeCount(), scratch);
+    excessScaling(allowedEdges, labels, allowedBuffer, large, valueOnly, source, sink, *this);
+  } else {
+    LabelBuckets buckets(getNodeCount(), 2*getNodeCount(), scratch);
+    for (unsigned int a : initial) {
+      if (!buckets.contains(a)) {
+        buckets.insert(a, 0);
+      }
+    }
+    dischargeAll(allowedEdges, labels, allowedBuffer, buckets, valueOnly, source, sink, *this);
+  }
+  relabelBurst.flush();
+}
 
-      // Add the active node to the new bucket
-      labelBucket[labels[active.getId()]].push_back(active.getId());
+// Sets the strategy for choosing active nodes in pushRelabel
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::setSelection(ActiveSelection s) {
+  selection = s;
+}
 
+// Push relabel algorithm with s = 0 and t = 1
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::pushRelabel(bool valueOnly) {
+  pushRelabel(0, 1, valueOnly);
+}
 
-      maxLabel = labels[active.getId()];
-    } else {
-      // Push can be done
-      Edge& allowed = getEdge(allowedEdges[active.getId()].front());
+// Sets the flow of all edges to 0
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::resetFlow() {
+  for (unsigned int e = 0; e < getEdgeCount(); e++) {
+    flows[e] = 0;
+  }
+  for (Node& n : nodes) {
+    n.inFlow = 0;
+    n.outFlow = 0;
+  }
+}
+
+// Gets the value of the flow, which is the excess of t
+template <typename Cap, typename Flow>
+unsigned long long int BasicGraph<Cap, Flow>::getFlowValue() {
+  return getNode(sink).getInFlow() - getNode(sink).getOutFlow();
+}
+
+// Checks whether the flow of the edges is only a maximum preflow
+template <typename Cap, typename Flow>
+bool BasicGraph<Cap, Flow>::isPreflowOnly() {
+  return preflowOnly;
+}
+
+// Declares the flow of the edges as the result of a max flow run from source
+// to sink, for flows which were computed on another graph
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::setFlowResult(unsigned int source, unsigned int sink, bool preflowOnly) {
+  this->source = source;
+  this->sink = sink;
+  this->preflowOnly = preflowOnly;
+}
 
-      // Check if the edge is really allowed, see comment in relabel
-      if ((active.getId() == allowed.getA() && labels[active.getId()] != labels[allowed.getB()]+1) ||
-        (active.getId() == allowed.getB() && labels[active.getId()] != labels[allowed.getA()]+1)) {
-        // the edge is not allowed and has to be removed
-        allowedEdges[active.getId()].pop_front();
-        continue;
+// Computes a minimum s-t cut after pushRelabel. The sink side consists of all
+// nodes which can reach t in the residual graph, so this also works if only a
+// maximum preflow was computed. sourceSide gets the remaining nodes, cutEdges
+// the (saturated) edges leaving the source side.
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::minCut(std::vector<unsigned int>& sourceSide, std::vector<unsigned int>& cutEdges) {
+  sourceSide.clear();
+  cutEdges.clear();
+
+  // Backwards search from t in the residual graph
+  std::vector<bool> reachesSink(getNodeCount(), false);
+  std::vector<unsigned int> queue;
+  queue.reserve(getNodeCount());
+  queue.push_back(sink);
+  reachesSink[sink] = true;
+  for (unsigned int i = 0; i < queue.size(); i++) {
+    Node& n = getNode(queue[i]);
+    // residual edges tails[e] -> n
+    for (unsigned int e : n.getInEdges()) {
+      if (flows[e] < capacities[e] && !reachesSink[tails[e]]) {
+        reachesSink[tails[e]] = true;
+        queue.push_back(tails[e]);
+      }
+    }
+    // residual backward edges heads[e] -> n
+    for (unsigned int e : n.getOutEdges()) {
+      if (flows[e] > 0 && !reachesSink[heads[e]]) {
+        reachesSink[heads[e]] = true;
+        queue.push_back(heads[e]);
       }
+    }
+  }
 
-      pushAllowedEdge(allowedEdges, labels, labelBucket, maxLabel, *this, active, allowed);
+  for (unsigned int i = 0; i < getNodeCount(); i++) {
+    if (!reachesSink[i]) {
+      sourceSide.push_back(i);
+    }
+  }
+  for (unsigned int e = 0; e < getEdgeCount(); e++) {
+    if (!reachesSink[tails[e]] && reachesSink[heads[e]]) {
+      cutEdges.push_back(e);
     }
   }
 }
 
-void Graph::exportFlow(std::ostream& out) {
-  unsigned long long int flowValue = getNode(0).getOutFlow() - getNode(0).getInFlow();
-  out << flowValue << '\n';
-  for (Edge& e : edges) {
-    if (e.getFlow() > 0) {
-      out << e.getId() << " " << e.getFlow() << '\n';
+// Checks the result of the last max flow run in O(n + m): the flow respects
+// the capacities, flow conservation holds at every node except s and t (only
+// a non-negative excess for a preflow), and the capacity of the residual cut
+// of minCut equals the flow value, which proves maximality. On failure, error
+// gets the reason.
+template <typename Cap, typename Flow>
+bool BasicGraph<Cap, Flow>::verifyFlow(std::string& error) {
+  std::vector<unsigned long long int> inFlows(getNodeCount(), 0);
+  std::vector<unsigned long long int> outFlows(getNodeCount(), 0);
+  for (unsigned int e = 0; e < getEdgeCount(); e++) {
+    if (flows[e] > capacities[e]) {
+      error = "The flow of edge " + std::to_string(e) + " exceeds its capacity";
+      return false;
+    }
+    outFlows[tails[e]] += flows[e];
+    inFlows[heads[e]] += flows[e];
+  }
+
+  for (unsigned int i = 0; i < getNodeCount(); i++) {
+    if (i == source || i == sink) {
+      continue;
+    }
+    if (inFlows[i] < outFlows[i] || (!preflowOnly && inFlows[i] != outFlows[i])) {
+      error = "Flow conservation is violated at node " + std::to_string(i);
+      return false;
+    }
+  }
+  if (inFlows[sink] < outFlows[sink] || inFlows[sink] - outFlows[sink] != getFlowValue()) {
+    error = "The flow value does not match the excess of t";
+    return false;
+  }
+
+  // Every edge of the cut is saturated and every edge back into the source
+  // side is empty, the cut capacity then equals the flow value
+  std::vector<unsigned int> sourceSide;
+  std::vector<unsigned int> cutEdges;
+  minCut(sourceSide, cutEdges);
+  unsigned long long int cutCapacity = 0;
+  for (unsigned int e : cutEdges) {
+    cutCapacity += capacities[e];
+  }
+  if (std::find(sourceSide.begin(), sourceSide.end(), source) == sourceSide.end()) {
+    error = "There is an augmenting path from s to t";
+    return false;
+  }
+  if (cutCapacity != getFlowValue()) {
+    error = "The cut capacity " + std::to_string(cutCapacity) + " differs from the flow value";
+    return false;
+  }
+  return true;
+}
+
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::exportFlow(std::ostream& out) {
+  Writer w(out);
+  w.writeUInt(getFlowValue());
+  w.writeChar('\n');
+
+  // Without a valid flow, only the value is known
+  if (preflowOnly) {
+    return;
+  }
+  for (unsigned int e = 0; e < getEdgeCount(); e++) {
+    if (flows[e] > 0) {
+      w.writeUInt(e);
+      w.writeChar(' ');
+      w.writeUInt(flows[e]);
+      w.writeChar('\n');
     }
   }
 }
+
+// Exports the flow in binary format (little endian):
+// "EDMFLOW1", the flow value (64 bit), the number k of edges with flow (32 bit)
+// and k pairs of edge id and flow (32 bit each). Graphs with 64 bit
+// capacities use "EDMFLOW2" and write the flows of the edges with 64 bits.
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::exportFlowBinary(std::ostream& out) {
+  unsigned int count = 0;
+  if (!preflowOnly) {
+    for (unsigned int e = 0; e < getEdgeCount(); e++) {
+      if (flows[e] > 0) {
+        count++;
+      }
+    }
+  }
+
+  bool wide = sizeof(Cap) > 4;
+  Writer w(out);
+  w.writeBytes(wide ? "EDMFLOW2" : "EDMFLOW1", 8);
+  w.writeUInt64(getFlowValue());
+  w.writeUInt32(count);
+  for (unsigned int e = 0; e < getEdgeCount() && count > 0; e++) {
+    if (flows[e] > 0) {
+      w.writeUInt32(e);
+      if (wide) {
+        w.writeUInt64(flows[e]);
+      } else {
+        w.writeUInt32(flows[e]);
+      }
+    }
+  }
+}
+
+// Exports a minimum cut: its capacity, the nodes of the source side and the
+// ids of the cut edges
+template <typename Cap, typename Flow>
+void BasicGraph<Cap, Flow>::exportCut(std::ostream& out) {
+  std::vector<unsigned int> sourceSide;
+  std::vector<unsigned int> cutEdges;
+  minCut(sourceSide, cutEdges);
+
+  unsigned long long int capacity = 0;
+  for (unsigned int e : cutEdges) {
+    capacity += capacities[e];
+  }
+
+  Writer w(out);
+  w.writeUInt(capacity);
+  w.writeChar('\n');
+  w.writeUInt(sourceSide.size());
+  w.writeChar('\n');
+  for (unsigned int n : sourceSide) {
+    w.writeUInt(n);
+    w.writeChar('\n');
+  }
+  w.writeUInt(cutEdges.size());
+  w.writeChar('\n');
+  for (unsigned int e : cutEdges) {
+    w.writeUInt(e);
+    w.writeChar('\n');
+  }
+}
+
+// Instantiations for 16, 32 and 64 bit capacities
+template class BasicGraph<unsigned short int, unsigned int>;
+template class BasicGraph<unsigned short int, unsigned long long int>;
+template class BasicGraph<unsigned int, unsigned int>;
+template class BasicGraph<unsigned int, unsigned long long int>;
+template class BasicGraph<unsigned long long int, unsigned long long int>;
@@ -5,69 +5,140 @@
 #include <list>
 #include <string>
 #include <iostream>
+#include "Arena.h"
+#include "PageMemory.h"
+#include "ActiveNodes.h"
+#include "Instance.h"
 
-// Class for a graph
-class Graph {
+// Class for a graph with edge capacities (and flows) of type Cap. The flow
+// into and out of a node is summed up in type Flow, which has to be large
+// enough for the capacity sums of the nodes. Instantiations exist for
+// unsigned 16, 32 and 64 bit capacities, see the end of Graph.cpp.
+template <typename Cap, typename Flow>
+class BasicGraph {
 public:
   class Edge;
   class Node;
 
-  void setFlow(Edge& e, unsigned int fl);
+  typedef Cap CapacityType;
+  typedef Flow FlowType;
+
+  // Adjacency list of a node, allocated from the arena of the graph
+  typedef ArenaVector<unsigned int> EdgeList;
+
+  // Read-only view of a contiguous array of edge attributes
+  template <typename T>
+  class ArrayView {
+  public:
+    ArrayView(const T* data, unsigned int size) : ptr(data), count(size) { }
+    const T& operator[](unsigned int i) const { return ptr[i]; }
+    const T* data() const { return ptr; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+    unsigned int size() const { return count; }
+  private:
+    const T* ptr;
+    unsigned int count;
+  };
+
+  void setFlow(Edge e, Cap fl);
+  void resetFlow();
   void addOutEdge(Node& n, unsigned int e);
   void addInEdge(Node& n, unsigned int e);
 
-  // An edge in the graph between two nodes
+  // A handle to an edge, the edge data itself is stored in the edge arrays
+  // of the graph
   class Edge {
   public:
-    Edge(unsigned int a, unsigned int b, unsigned int capacity, unsigned int id);
+    Edge(BasicGraph* g, unsigned int id);
     unsigned int getId();
     unsigned int getA();
     unsigned int getB();
-    unsigned int getCapacity();
-    unsigned int getFlow();
-    friend void Graph::setFlow(Edge& e, unsigned int fl);
+    Cap getCapacity();
+    Cap getFlow();
   private:
+    BasicGraph* g;
     unsigned int id;
-    unsigned int a;
-    unsigned int b;
-    unsigned int capacity;
-    unsigned int flow = 0;
   };
 
   // A node in the graph
   class Node {
   public:
-    Node(unsigned int id);
+    Node(unsigned int id, Arena& arena);
     unsigned int getId();
-    friend void Graph::addOutEdge(Node& n, unsigned int e);
-    friend void Graph::addInEdge(Node& n, unsigned int e);
-    std::vector<unsigned int>& getOutEdges();
-    std::vector<unsigned int>& getInEdges();
-    unsigned long long int getOutFlow();
-    unsigned long long int getInFlow();
-    friend void Graph::setFlow(Edge& e, unsigned int fl);
+    friend void BasicGraph::addOutEdge(Node& n, unsigned int e);
+    friend void BasicGraph::addInEdge(Node& n, unsigned int e);
+    EdgeList& getOutEdges();
+    EdgeList& getInEdges();
+    Flow getOutFlow();
+    Flow getInFlow();
+    friend void BasicGraph::setFlow(Edge e, Cap fl);
+    friend void BasicGraph::resetFlow();
   private:
     unsigned int id;
-    unsigned long long int inFlow = 0;
-    unsigned long long int outFlow = 0;
-    std::vector<unsigned int> inEdges;
-    std::vector<unsigned int> outEdges;
+    Flow inFlow = 0;
+    Flow outFlow = 0;
+    EdgeList inEdges;
+    EdgeList outEdges;
   };
 
-  Graph(unsigned int nodeCount);
-  Graph(std::string filename);
-  void addEdge(unsigned int a, unsigned int b, unsigned int capacity);
+  BasicGraph(unsigned int nodeCount);
+  BasicGraph(std::string filename);
+  BasicGraph(Instance& instance);
+  void addEdge(unsigned int a, unsigned int b, Cap capacity);
   unsigned int getNodeCount();
   unsigned int getEdgeCount();
   Node& getNode(unsigned int a);
-  Edge& getEdge(unsigned int a);
-  void pushRelabel();
+  Edge getEdge(unsigned int a);
+  ArrayView<unsigned int> getTails();
+  ArrayView<unsigned int> getHeads();
+  ArrayView<Cap> getCapacities();
+  ArrayView<Cap> getFlows();
+  void setSelection(ActiveSelection s);
+  void pushRelabel(bool valueOnly = false);
+  void pushRelabel(unsigned int source, unsigned int sink, bool valueOnly = false);
+  void boykovKolmogorov();
+  void boykovKolmogorov(unsigned int source, unsigned int sink);
+  unsigned long long int getFlowValue();
+  bool isPreflowOnly();
+  void setFlowResult(unsigned int source, unsigned int sink, bool preflowOnly);
+  void minCut(std::vector<unsigned int>& sourceSide, std::vector<unsigned int>& cutEdges);
+  bool verifyFlow(std::string& error);
   void exportFlow(std::ostream& out);
-  friend std::ostream& operator<<(std::ostream& out, const Graph& o);
+  void exportFlowBinary(std::ostream& out);
+  void exportCut(std::ostream& out);
 private:
+  void initNodes(unsigned int nc);
+
   unsigned int nodeCount;
-  std::vector<Node> nodes;
-  std::vector<Edge> edges;
+
+  // Memory of the adjacency lists, has to outlive the nodes
+  Arena graphArena;
+  // Memory of the solver state, reset at the start of every run
+  Arena scratch;
+
+  PageVector<Node> nodes;
+
+  // Source and sink of the last run of the max flow algorithm
+  unsigned int source = 0;
+  unsigned int sink = 1;
+
+  // Strategy for choosing the next active node in pushRelabel
+  ActiveSelection selection = HIGHEST_LABEL;
+
+  // True if the last run of pushRelabel only computed a maximum preflow
+  bool preflowOnly = false;
+
+  // Edge data, indexed by edge id. capacities and flows have one padding
+  // element at the end, so that vector kernels can load a 32 bit word at the
+  // position of the last 16 bit value.
+  PageVector<unsigned int> tails;
+  PageVector<unsigned int> heads;
+  PageVector<Cap> capacities;
+  PageVector<Cap> flows;
 };
 
+// Graph with the capacity types of the original instance format
+typedef BasicGraph<unsigned int, unsigned long long int> Graph;
+
 #endif
@@ -0,0 +1,210 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <thread>
+#include <functional>
+#include "Instance.h"
+
+namespace {
+
+// Files below this size per thread are not split
+const std::size_t minChunkSize = 1 << 20;
+
+// The edges of one chunk of an instance file
+struct EdgeChunk {
+  std::vector<unsigned int> tails;
+  std::vector<unsigned int> heads;
+  std::vector<unsigned long long int> capacities;
+  // false if parsing stopped before the end of the chunk
+  bool complete = false;
+  // false if an edge has a non-existing node
+  bool valid = true;
+};
+
+// Skips whitespace and reads an unsigned number at p, returns false if there
+// is none
+bool readNumber(const char*& p, const char* end, unsigned long long int& value) {
+  while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+    p++;
+  }
+  if (p == end || *p < '0' || *p > '9') {
+    return false;
+  }
+  value = 0;
+  while (p < end && *p >= '0' && *p <= '9') {
+    value = value*10 + (*p - '0');
+    p++;
+  }
+  return true;
+}
+
+// Parses the edge lines between begin and end
+void parseChunk(const char* begin, const char* end, unsigned int nodeCount, EdgeChunk& chunk) {
+  unsigned long long int a, b, capacity;
+  while (readNumber(begin, end, a) && readNumber(begin, end, b) && readNumber(begin, end, capacity)) {
+    if (a >= nodeCount || b >= nodeCount) {
+      chunk.valid = false;
+      return;
+    }
+    chunk.tails.push_back(a);
+    chunk.heads.push_back(b);
+    chunk.capacities.push_back(capacity);
+  }
+  chunk.complete = begin == end;
+}
+
+// Copies the edges of a chunk to their position in the instance arrays
+void copyChunk(const EdgeChunk& chunk, unsigned int* tails, unsigned int* heads, unsigned long long int* capacities) {
+  std::copy(chunk.tails.begin(), chunk.tails.end(), tails);
+  std::copy(chunk.heads.begin(), chunk.heads.end(), heads);
+  std::copy(chunk.capacities.begin(), chunk.capacities.end(), capacities);
+}
+
+}
+
+// Parses an instance file. The edge lines are split into up to threadCount
+// chunks at line ends, which are parsed in parallel and concatenated in file
+// order, so edge ids are the same as with sequential parsing. Like a stream,
+// parsing stops at the first malformed edge.
+Instance::Instance(std::string filename, unsigned int threadCount) {
+  std::fstream file(filename, std::ios_base::in | std::ios_base::binary);
+
+  // Check if file is open
+  if (!file.is_open()) {
+    nodeCount = 0;
+    throw(std::runtime_error("File could not be opened."));
+    return;
+  }
+
+  file.seekg(0, std::ios_base::end);
+  std::string text(static_cast<std::size_t>(file.tellg()), '\0');
+  file.seekg(0, std::ios_base::beg);
+  file.read(&text[0], text.size());
+
+  const char* p = text.data();
+  const char* end = p + text.size();
+  unsigned long long int n = 0;
+  readNumber(p, end, n);
+  nodeCount = n;
+
+  // Chunk borders are moved behind the next line end
+  std::size_t size = end - p;
+  unsigned int chunkCount = std::max(1u, std::min(threadCount, static_cast<unsigned int>(size / minChunkSize)));
+  std::vector<const char*> borders(chunkCount + 1, end);
+  borders[0] = p;
+  for (unsigned int i = 1; i < chunkCount; i++) {
+    const char* border = std::max(borders[i-1], p + size / chunkCount * i);
+    border = std::find(border, end, '\n');
+    borders[i] = border == end ? end : border + 1;
+  }
+
+  std::vector<EdgeChunk> chunks(chunkCount);
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < chunkCount; i++) {
+    threads.push_back(std::thread(parseChunk, borders[i], borders[i+1], nodeCount, std::ref(chunks[i])));
+  }
+  parseChunk(borders[0], borders[1], nodeCount, chunks[0]);
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  // Only the chunks up to the first incomplete one are used
+  std::vector<unsigned int> offsets(1, 0);
+  for (unsigned int i = 0; i < chunkCount; i++) {
+    if (!chunks[i].valid) {
+      throw(std::runtime_error("Tried to add an edge to a non-existing node."));
+    }
+    offsets.push_back(offsets.back() + chunks[i].tails.size());
+    if (!chunks[i].complete) {
+      chunkCount = i + 1;
+      break;
+    }
+  }
+
+  tails.resize(offsets.back());
+  heads.resize(offsets.back());
+  capacities.resize(offsets.back());
+  threads.clear();
+  for (unsigned int i = 1; i < chunkCount; i++) {
+    threads.push_back(std::thread(copyChunk, std::cref(chunks[i]), tails.data() + offsets[i], heads.data() + offsets[i],
+      capacities.data() + offsets[i]));
+  }
+  copyChunk(chunks[0], tails.data(), heads.data(), capacities.data());
+  for (std::thread& t : threads) {
+    t.join();
+  }
+}
+
+// Constructs an instance without edges
+Instance::Instance(unsigned int nodeCount) : nodeCount(nodeCount) { }
+
+// Adds an edge to the instance
+void Instance::addEdge(unsigned int a, unsigned int b, unsigned long long int capacity) {
+  if (a >= nodeCount || b >= nodeCount) {
+    throw(std::runtime_error("Tried to add an edge to a non-existing node."));
+  }
+  tails.push_back(a);
+  heads.push_back(b);
+  capacities.push_back(capacity);
+}
+
+// Gets the node count of the instance
+unsigned int Instance::getNodeCount() {
+  return nodeCount;
+}
+
+// Gets the edge count of the instance
+unsigned int Instance::getEdgeCount() {
+  return tails.size();
+}
+
+// Gets the tail of an edge
+unsigned int Instance::getTail(unsigned int e) {
+  return tails[e];
+}
+
+// Gets the head of an edge
+unsigned int Instance::getHead(unsigned int e) {
+  return heads[e];
+}
+
+// Gets the capacity of an edge
+unsigned long long int Instance::getCapacity(unsigned int e) {
+  return capacities[e];
+}
+
+// Gets the largest edge capacity
+unsigned long long int Instance::getMaxCapacity() {
+  unsigned long long int res = 0;
+  for (unsigned long long int c : capacities) {
+    if (c > res) {
+      res = c;
+    }
+  }
+  return res;
+}
+
+// Gets the largest sum of the capacities going into or out of a node, which
+// bounds the flow sums of the nodes. Saturates at the largest 64 bit value.
+unsigned long long int Instance::getMaxNodeCapacity() {
+  const unsigned long long int limit = ~0ULL;
+  std::vector<unsigned long long int> in(nodeCount, 0);
+  std::vector<unsigned long long int> out(nodeCount, 0);
+  for (unsigned int e = 0; e < getEdgeCount(); e++) {
+    in[heads[e]] = capacities[e] > limit - in[heads[e]] ? limit : in[heads[e]] + capacities[e];
+    out[tails[e]] = capacities[e] > limit - out[tails[e]] ? limit : out[tails[e]] + capacities[e];
+  }
+
+  unsigned long long int res = 0;
+  for (unsigned int i = 0; i < nodeCount; i++) {
+    if (in[i] > res) {
+      res = in[i];
+    }
+    if (out[i] > res) {
+      res = out[i];
+    }
+  }
+  return res;
+}
@@ -0,0 +1,28 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include <vector>
+#include <string>
+
+// The edges of a flow network as read from an instance file. The graph is
+// built from it once the needed capacity types are known.
+class Instance {
+public:
+  Instance(std::string filename, unsigned int threadCount = 1);
+  Instance(unsigned int nodeCount);
+  void addEdge(unsigned int a, unsigned int b, unsigned long long int capacity);
+  unsigned int getNodeCount();
+  unsigned int getEdgeCount();
+  unsigned int getTail(unsigned int e);
+  unsigned int getHead(unsigned int e);
+  unsigned long long int getCapacity(unsigned int e);
+  unsigned long long int getMaxCapacity();
+  unsigned long long int getMaxNodeCapacity();
+private:
+  unsigned int nodeCount;
+  std::vector<unsigned int> tails;
+  std::vector<unsigned int> heads;
+  std::vector<unsigned long long int> capacities;
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "Reduction.h"
+#include "Instance.h"
+#include "Graph.h"
+
+// Marks all nodes reachable from start, the edges of node a are
+// list[start[a]], ..., list[start[a+1]-1]
+static std::vector<bool> search(unsigned int from, std::vector<unsigned int>& start, std::vector<unsigned int>& list,
+  std::vector<unsigned int>& ends) {
+  std::vector<bool> reached(start.size() - 1, false);
+  std::vector<unsigned int> queue;
+  queue.push_back(from);
+  reached[from] = true;
+  for (unsigned int i = 0; i < queue.size(); i++) {
+    for (unsigned int j = start[queue[i]]; j < start[queue[i]+1]; j++) {
+      unsigned int b = ends[list[j]];
+      if (!reached[b]) {
+        reached[b] = true;
+        queue.push_back(b);
+      }
+    }
+  }
+  return reached;
+}
+
+// Builds the adjacency lists of the given edges grouped by the node keys[e]
+static void groupEdges(std::vector<unsigned int>& edges, std::vector<unsigned int>& keys, unsigned int nodeCount,
+  std::vector<unsigned int>& start, std::vector<unsigned int>& list) {
+  start.assign(nodeCount + 1, 0);
+  for (unsigned int e : edges) {
+    start[keys[e]+1]++;
+  }
+  for (unsigned int i = 0; i < nodeCount; i++) {
+    start[i+1] += start[i];
+  }
+  list.resize(edges.size());
+  std::vector<unsigned int> pos(start.begin(), start.end() - 1);
+  for (unsigned int e : edges) {
+    list[pos[keys[e]]++] = e;
+  }
+}
+
+// Reduces an instance for a flow from source to sink
+Reduction::Reduction(Instance& instance, unsigned int source, unsigned int sink) : reduced(0) {
+  unsigned int n = instance.getNodeCount();
+  if (source >= n || sink >= n || source == sink) {
+    throw(std::runtime_error("Reduction: Invalid source or sink."));
+  }
+
+  // Edges which can carry flow of a maximum flow
+  std::vector<unsigned int> tails(instance.getEdgeCount());
+  std::vector<unsigned int> heads(instance.getEdgeCount());
+  std::vector<unsigned int> usable;
+  for (unsigned int e = 0; e < instance.getEdgeCount(); e++) {
+    tails[e] = instance.getTail(e);
+    heads[e] = instance.getHead(e);
+    if (instance.getCapacity(e) > 0 && tails[e] != heads[e] && heads[e] != source && tails[e] != sink) {
+      usable.push_back(e);
+    }
+  }
+
+  // Forward search from s and backward search from t
+  std::vector<unsigned int> start, list;
+  groupEdges(usable, tails, n, start, list);
+  std::vector<bool> fromSource = search(source, start, list, heads);
+  groupEdges(usable, heads, n, start, list);
+  std::vector<bool> toSink = search(sink, start, list, tails);
+
+  // New node ids
+  const unsigned int removed = ~0u;
+  std::vector<unsigned int> newIds(n, removed);
+  newIds[source] = 0;
+  newIds[sink] = 1;
+  originalNodes.push_back(source);
+  originalNodes.push_back(sink);
+  for (unsigned int i = 0; i < n; i++) {
+    if (i != source && i != sink && fromSource[i] && toSink[i]) {
+      newIds[i] = originalNodes.size();
+      originalNodes.push_back(i);
+    }
+  }
+
+  // Remaining edges sorted by their new end nodes, parallel edges are
+  // consecutive and keep their order
+  for (unsigned int e : usable) {
+    if (newIds[tails[e]] != removed && newIds[heads[e]] != removed) {
+      originalEdges.push_back(e);
+    }
+  }
+  std::sort(originalEdges.begin(), originalEdges.end(), [&](unsigned int e, unsigned int f) {
+    if (newIds[tails[e]] != newIds[tails[f]]) {
+      return newIds[tails[e]] < newIds[tails[f]];
+    }
+    if (newIds[heads[e]] != newIds[heads[f]]) {
+      return newIds[heads[e]] < newIds[heads[f]];
+    }
+    return e < f;
+  });
+
+  // Merge the parallel edges, the capacity sum saturates at the largest value
+  reduced = Instance(originalNodes.size());
+  for (unsigned int i = 0; i < originalEdges.size(); ) {
+    unsigned int e = originalEdges[i];
+    unsigned long long int capacity = 0;
+    groupStart.push_back(i);
+    for (; i < originalEdges.size() && tails[originalEdges[i]] == tails[e] && heads[originalEdges[i]] == heads[e]; i++) {
+      unsigned long long int c = instance.getCapacity(originalEdges[i]);
+      capacity = c > ~0ULL - capacity ? ~0ULL : capacity + c;
+    }
+    reduced.addEdge(newIds[tails[e]], newIds[heads[e]], capacity);
+  }
+  groupStart.push_back(originalEdges.size());
+}
+
+// Gets the reduced instance
+Instance& Reduction::getInstance() {
+  return reduced;
+}
+
+// Gets the original id of a node of the reduced instance
+unsigned int Reduction::getOriginalNode(unsigned int a) {
+  return originalNodes[a];
+}
+
+// Sets the flow of the original graph to the flow of the reduced graph. The
+// flow of a merged edge is distributed over its original edges in edge order.
+template <typename G>
+void Reduction::expandFlow(G& reducedGraph, G& original) {
+  typedef typename G::CapacityType Cap;
+
+  original.resetFlow();
+  for (unsigned int r = 0; r < reducedGraph.getEdgeCount(); r++) {
+    Cap left = reducedGraph.getEdge(r).getFlow();
+    for (unsigned int i = groupStart[r]; i < groupStart[r+1] && left > 0; i++) {
+      typename G::Edge e = original.getEdge(originalEdges[i]);
+      Cap flow = left < e.getCapacity() ? left : e.getCapacity();
+      original.setFlow(e, flow);
+      left -= flow;
+    }
+  }
+  original.setFlowResult(originalNodes[0], originalNodes[1], reducedGraph.isPreflowOnly());
+}
+
+template void Reduction::expandFlow(BasicGraph<unsigned short int, unsigned int>&, BasicGraph<unsigned short int, unsigned int>&);
+template void Reduction::expandFlow(BasicGraph<unsigned short int, unsigned long long int>&, BasicGraph<unsigned short int, unsigned long long int>&);
+template void Reduction::expandFlow(BasicGraph<unsigned int, unsigned int>&, BasicGraph<unsigned int, unsigned int>&);
+template void Reduction::expandFlow(BasicGraph<unsigned int, unsigned long long int>&, BasicGraph<unsigned int, unsigned long long int>&);
+template void Reduction::expandFlow(BasicGraph<unsigned long long int, unsigned long long int>&, BasicGraph<unsigned long long int, unsigned long long int>&);
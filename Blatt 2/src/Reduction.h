@@ -0,0 +1,32 @@
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+#include <vector>
+#include "Instance.h"
+
+// Reduced version of a flow instance with the same maximum flow value. Nodes
+// which cannot be reached from s or cannot reach t are removed, as well as
+// loops, edges without capacity and edges into s or out of t. Parallel edges
+// are merged into one edge with the sum of their capacities.
+//
+// In the reduced instance, s has the id 0 and t the id 1, the other nodes
+// keep their order. A flow of the reduced graph can be expanded to the
+// original graph.
+class Reduction {
+public:
+  Reduction(Instance& instance, unsigned int source, unsigned int sink);
+  Instance& getInstance();
+  unsigned int getOriginalNode(unsigned int a);
+  template <typename G>
+  void expandFlow(G& reduced, G& original);
+private:
+  Instance reduced;
+  // original id of every node of the reduced instance
+  std::vector<unsigned int> originalNodes;
+  // the original edges of the reduced edge r are
+  // originalEdges[groupStart[r]], ..., originalEdges[groupStart[r+1]-1]
+  std::vector<unsigned int> groupStart;
+  std::vector<unsigned int> originalEdges;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include "Reordering.h"
+#include "Instance.h"
+#include "Graph.h"
+
+// Renumbers the nodes of an instance for a flow from source to sink
+Reordering::Reordering(Instance& instance, unsigned int source, unsigned int sink, NodeOrder order) : reordered(0) {
+  unsigned int n = instance.getNodeCount();
+  unsigned int m = instance.getEdgeCount();
+  if (source >= n || sink >= n || source == sink) {
+    throw(std::runtime_error("Reordering: Invalid source or sink."));
+  }
+
+  // Adjacency lists of the edges in both directions, the neighbours of node a
+  // are neighbours[start[a]], ..., neighbours[start[a+1]-1]
+  std::vector<unsigned int> start(n + 1, 0);
+  for (unsigned int e = 0; e < m; e++) {
+    start[instance.getTail(e)+1]++;
+    start[instance.getHead(e)+1]++;
+  }
+  for (unsigned int i = 0; i < n; i++) {
+    start[i+1] += start[i];
+  }
+  std::vector<unsigned int> neighbours(start[n]);
+  std::vector<unsigned int> pos(start.begin(), start.end() - 1);
+  for (unsigned int e = 0; e < m; e++) {
+    neighbours[pos[instance.getTail(e)]++] = instance.getHead(e);
+    neighbours[pos[instance.getHead(e)]++] = instance.getTail(e);
+  }
+  auto byDegree = [&](unsigned int a, unsigned int b) {
+    return start[a+1] - start[a] < start[b+1] - start[b];
+  };
+
+  // Every component is searched from the first unvisited root: s and then all
+  // nodes by id for BFS, all nodes by degree for RCM
+  std::vector<unsigned int> roots(n);
+  std::iota(roots.begin(), roots.end(), 0);
+  if (order == BFS_ORDER) {
+    roots.insert(roots.begin(), source);
+  } else {
+    std::stable_sort(roots.begin(), roots.end(), byDegree);
+  }
+
+  std::vector<unsigned int> sequence;
+  sequence.reserve(n);
+  std::vector<bool> visited(n, false);
+  for (unsigned int root : roots) {
+    if (visited[root]) {
+      continue;
+    }
+    visited[root] = true;
+    sequence.push_back(root);
+    for (unsigned int i = sequence.size() - 1; i < sequence.size(); i++) {
+      unsigned int a = sequence[i];
+      unsigned int first = sequence.size();
+      for (unsigned int j = start[a]; j < start[a+1]; j++) {
+        if (!visited[neighbours[j]]) {
+          visited[neighbours[j]] = true;
+          sequence.push_back(neighbours[j]);
+        }
+      }
+      if (order == RCM_ORDER) {
+        std::stable_sort(sequence.begin() + first, sequence.end(), byDegree);
+      }
+    }
+  }
+  if (order == RCM_ORDER) {
+    std::reverse(sequence.begin(), sequence.end());
+  }
+
+  // New node ids, s and t keep their place at the start
+  std::vector<unsigned int> newIds(n);
+  newIds[source] = 0;
+  newIds[sink] = 1;
+  originalNodes.push_back(source);
+  originalNodes.push_back(sink);
+  for (unsigned int a : sequence) {
+    if (a != source && a != sink) {
+      newIds[a] = originalNodes.size();
+      originalNodes.push_back(a);
+    }
+  }
+
+  // The edges keep their ids and order, sorting them by the new ids changes
+  // the order of the adjacency lists, which made push relabel much slower
+  reordered = Instance(n);
+  for (unsigned int e = 0; e < m; e++) {
+    reordered.addEdge(newIds[instance.getTail(e)], newIds[instance.getHead(e)], instance.getCapacity(e));
+  }
+}
+
+// Gets the reordered instance
+Instance& Reordering::getInstance() {
+  return reordered;
+}
+
+// Gets the original id of a node of the reordered instance
+unsigned int Reordering::getOriginalNode(unsigned int a) {
+  return originalNodes[a];
+}
+
+// Sets the flow of the original graph to the flow of the reordered graph
+template <typename G>
+void Reordering::expandFlow(G& reorderedGraph, G& original) {
+  original.resetFlow();
+  for (unsigned int e = 0; e < reorderedGraph.getEdgeCount(); e++) {
+    original.setFlow(original.getEdge(e), reorderedGraph.getEdge(e).getFlow());
+  }
+  original.setFlowResult(originalNodes[0], originalNodes[1], reorderedGraph.isPreflowOnly());
+}
+
+template void Reordering::expandFlow(BasicGraph<unsigned short int, unsigned int>&, BasicGraph<unsigned short int, unsigned int>&);
+template void Reordering::expandFlow(BasicGraph<unsigned short int, unsigned long long int>&, BasicGraph<unsigned short int, unsigned long long int>&);
+template void Reordering::expandFlow(BasicGraph<unsigned int, unsigned int>&, BasicGraph<unsigned int, unsigned int>&);
+template void Reordering::expandFlow(BasicGraph<unsigned int, unsigned long long int>&, BasicGraph<unsigned int, unsigned long long int>&);
+template void Reordering::expandFlow(BasicGraph<unsigned long long int, unsigned long long int>&, BasicGraph<unsigned long long int, unsigned long long int>&);
@@ -0,0 +1,35 @@
+#ifndef REORDERING_H
+#define REORDERING_H
+
+#include <vector>
+#include "Instance.h"
+
+// Orders for the node renumbering
+enum NodeOrder {
+  // breadth first search from s over the edges in both directions
+  BFS_ORDER,
+  // reverse Cuthill-McKee: breadth first search from a node of small degree,
+  // neighbours in order of increasing degree, the whole order reversed
+  RCM_ORDER
+};
+
+// Copy of a flow instance with renumbered nodes, so that nodes which are close
+// in the graph get close ids and the arrays indexed by node id are accessed
+// with better locality. The edges keep their ids.
+//
+// As in a reduced instance, s has the id 0 and t the id 1. A flow of the
+// reordered graph can be expanded to the original graph.
+class Reordering {
+public:
+  Reordering(Instance& instance, unsigned int source, unsigned int sink, NodeOrder order);
+  Instance& getInstance();
+  unsigned int getOriginalNode(unsigned int a);
+  template <typename G>
+  void expandFlow(G& reordered, G& original);
+private:
+  Instance reordered;
+  // original id of every node of the reordered instance
+  std::vector<unsigned int> originalNodes;
+};
+
+#endif
@@ -0,0 +1,181 @@
+#include "Simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+// Scalar version of minResidualLabel
+template <typename T>
+static unsigned int minResidualLabelScalar(const unsigned int* edges, unsigned int count, const unsigned int* ends,
+  const T* flows, const T* bounds, const unsigned int* labels, unsigned int minimum) {
+  for (unsigned int i = 0; i < count; i++) {
+    unsigned int e = edges[i];
+    T bound = bounds ? bounds[e] : 0;
+    if (flows[e] != bound && labels[ends[e]] < minimum) {
+      minimum = labels[ends[e]];
+    }
+  }
+  return minimum;
+}
+
+// Scalar version of collectAllowedEdges
+template <typename T>
+static unsigned int collectAllowedEdgesScalar(const unsigned int* edges, unsigned int count, const unsigned int* ends,
+  const T* flows, const T* bounds, const unsigned int* labels, unsigned int target,
+  unsigned int* out) {
+  unsigned int found = 0;
+  for (unsigned int i = 0; i < count; i++) {
+    unsigned int e = edges[i];
+    T bound = bounds ? bounds[e] : 0;
+    if (flows[e] != bound && labels[ends[e]] == target) {
+      out[found++] = e;
+    }
+  }
+  return found;
+}
+
+#ifdef SIMD_AVX2
+
+// Gathers the values of arr at the 8 given indices
+__attribute__((target("avx2")))
+static inline __m256i gather(const unsigned int* arr, __m256i idx) {
+  return _mm256_i32gather_epi32(reinterpret_cast<const int*>(arr), idx, 4);
+}
+
+// Mask of the lanes whose edges are not in the residual graph
+__attribute__((target("avx2")))
+static inline __m256i saturatedMask(__m256i idx, const unsigned int* flows, const unsigned int* bounds) {
+  __m256i bound = bounds ? gather(bounds, idx) : _mm256_setzero_si256();
+  return _mm256_cmpeq_epi32(gather(flows, idx), bound);
+}
+
+// 16 bit version, loads the 32 bit words at the positions of the values and
+// keeps the lower halves (this needs the padding element)
+__attribute__((target("avx2")))
+static inline __m256i saturatedMask(__m256i idx, const unsigned short int* flows, const unsigned short int* bounds) {
+  __m256i low = _mm256_set1_epi32(0xffff);
+  __m256i flow = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(flows), idx, 2), low);
+  __m256i bound = _mm256_setzero_si256();
+  if (bounds) {
+    bound = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(bounds), idx, 2), low);
+  }
+  return _mm256_cmpeq_epi32(flow, bound);
+}
+
+// 64 bit version, compares two halves of 4 lanes and packs the masks
+__attribute__((target("avx2")))
+static inline __m256i saturatedMask(__m256i idx, const unsigned long long int* flows, const unsigned long long int* bounds) {
+  const long long* f = reinterpret_cast<const long long*>(flows);
+  const long long* b = reinterpret_cast<const long long*>(bounds);
+  __m128i idxLow = _mm256_castsi256_si128(idx);
+  __m128i idxHigh = _mm256_extracti128_si256(idx, 1);
+  __m256i boundLow = bounds ? _mm256_i32gather_epi64(b, idxLow, 8) : _mm256_setzero_si256();
+  __m256i boundHigh = bounds ? _mm256_i32gather_epi64(b, idxHigh, 8) : _mm256_setzero_si256();
+  __m256i maskLow = _mm256_cmpeq_epi64(_mm256_i32gather_epi64(f, idxLow, 8), boundLow);
+  __m256i maskHigh = _mm256_cmpeq_epi64(_mm256_i32gather_epi64(f, idxHigh, 8), boundHigh);
+
+  // every 64 bit mask consists of two equal 32 bit halves
+  __m256i even = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+  return _mm256_blend_epi32(_mm256_permutevar8x32_epi32(maskLow, even),
+    _mm256_permutevar8x32_epi32(maskHigh, even), 0xf0);
+}
+
+// AVX2 version of minResidualLabel, 8 edges per iteration
+template <typename T>
+__attribute__((target("avx2")))
+static unsigned int minResidualLabelAvx2(const unsigned int* edges, unsigned int count, const unsigned int* ends,
+  const T* flows, const T* bounds, const unsigned int* labels, unsigned int minimum) {
+  __m256i minv = _mm256_set1_epi32(static_cast<int>(minimum));
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(edges + i));
+    __m256i label = gather(labels, gather(ends, idx));
+    // saturated edges get the largest possible label
+    label = _mm256_or_si256(label, saturatedMask(idx, flows, bounds));
+    minv = _mm256_min_epu32(minv, label);
+  }
+
+  // horizontal minimum
+  __m128i m = _mm_min_epu32(_mm256_castsi256_si128(minv), _mm256_extracti128_si256(minv, 1));
+  m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+  m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+  minimum = static_cast<unsigned int>(_mm_cvtsi128_si32(m));
+
+  return minResidualLabelScalar(edges + i, count - i, ends, flows, bounds, labels, minimum);
+}
+
+// AVX2 version of collectAllowedEdges, 8 edges per iteration
+template <typename T>
+__attribute__((target("avx2")))
+static unsigned int collectAllowedEdgesAvx2(const unsigned int* edges, unsigned int count, const unsigned int* ends,
+  const T* flows, const T* bounds, const unsigned int* labels, unsigned int target,
+  unsigned int* out) {
+  __m256i targetv = _mm256_set1_epi32(static_cast<int>(target));
+  unsigned int found = 0;
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(edges + i));
+    __m256i match = _mm256_cmpeq_epi32(gather(labels, gather(ends, idx)), targetv);
+    match = _mm256_andnot_si256(saturatedMask(idx, flows, bounds), match);
+
+    // compress the matching lanes in list order
+    unsigned int bits = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(match)));
+    while (bits != 0) {
+      out[found++] = edges[i + __builtin_ctz(bits)];
+      bits &= bits - 1;
+    }
+  }
+
+  return found + collectAllowedEdgesScalar(edges + i, count - i, ends, flows, bounds, labels, target, out + found);
+}
+
+bool simdEnabled() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+
+#else
+
+bool simdEnabled() {
+  return false;
+}
+
+#endif
+
+template <typename T>
+unsigned int minResidualLabel(const unsigned int* edges, unsigned int count, const unsigned int* ends,
+  const T* flows, const T* bounds, const unsigned int* labels, unsigned int minimum) {
+#ifdef SIMD_AVX2
+  if (simdEnabled()) {
+    return minResidualLabelAvx2(edges, count, ends, flows, bounds, labels, minimum);
+  }
+#endif
+  return minResidualLabelScalar(edges, count, ends, flows, bounds, labels, minimum);
+}
+
+template <typename T>
+unsigned int collectAllowedEdges(const unsigned int* edges, unsigned int count, const unsigned int* ends,
+  const T* flows, const T* bounds, const unsigned int* labels, unsigned int target,
+  unsigned int* out) {
+#ifdef SIMD_AVX2
+  if (simdEnabled()) {
+    return collectAllowedEdgesAvx2(edges, count, ends, flows, bounds, labels, target, out);
+  }
+#endif
+  return collectAllowedEdgesScalar(edges, count, ends, flows, bounds, labels, target, out);
+}
+
+// Instantiations for 16, 32 and 64 bit flows
+template unsigned int minResidualLabel<unsigned short int>(const unsigned int*, unsigned int, const unsigned int*,
+  const unsigned short int*, const unsigned short int*, const unsigned int*, unsigned int);
+template unsigned int minResidualLabel<unsigned int>(const unsigned int*, unsigned int, const unsigned int*,
+  const unsigned int*, const unsigned int*, const unsigned int*, unsigned int);
+template unsigned int minResidualLabel<unsigned long long int>(const unsigned int*, unsigned int, const unsigned int*,
+  const unsigned long long int*, const unsigned long long int*, const unsigned int*, unsigned int);
+template unsigned int collectAllowedEdges<unsigned short int>(const unsigned int*, unsigned int, const unsigned int*,
+  const unsigned short int*, const unsigned short int*, const unsigned int*, unsigned int, unsigned int*);
+template unsigned int collectAllowedEdges<unsigned int>(const unsigned int*, unsigned int, const unsigned int*,
+  const unsigned int*, const unsigned int*, const unsigned int*, unsigned int, unsigned int*);
+template unsigned int collectAllowedEdges<unsigned long long int>(const unsigned int*, unsigned int, const unsigned int*,
+  const unsigned long long int*, const unsigned long long int*, const unsigned int*, unsigned int, unsigned int*);
@@ -0,0 +1,31 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// Vectorized scans over the adjacency lists of the push relabel algorithm.
+// Every function uses AVX2 if the cpu supports it (checked at runtime) and a
+// scalar loop otherwise. Both variants return exactly the same results.
+//
+// The edges of the adjacency list are given as edge ids. For every edge,
+// ends[e] is the node on the other side. An edge is in the residual graph iff
+// flows[e] != bounds[e], bounds == nullptr means that all bounds are 0
+// (residual backward edges). The functions exist for flows of type unsigned
+// short, unsigned int and unsigned long long. 16 bit flow and bound arrays
+// need one padding element at the end.
+
+// Returns true if the AVX2 kernels are used
+bool simdEnabled();
+
+// Returns the minimum of minimum and the labels of all nodes reachable over
+// residual edges of the list
+template <typename T>
+unsigned int minResidualLabel(const unsigned int* edges, unsigned int count, const unsigned int* ends,
+  const T* flows, const T* bounds, const unsigned int* labels, unsigned int minimum);
+
+// Writes the ids of the residual edges whose end node has the label target to
+// out (in list order) and returns their number. out needs space for count ids.
+template <typename T>
+unsigned int collectAllowedEdges(const unsigned int* edges, unsigned int count, const unsigned int* ends,
+  const T* flows, const T* bounds, const unsigned int* labels, unsigned int target,
+  unsigned int* out);
+
+#endif
@@ -7,21 +7,232 @@
 #include <vector>
 #include <list>
 #include <fstream>
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
 #include "Graph.h"
+#include "GomoryHu.h"
+#include "Instance.h"
+#include "Reduction.h"
+#include "Reordering.h"
+#include "Trace.h"
+#include "PageMemory.h"
+
+// Command line options
+struct Options {
+  std::string outputfile = "";
+  std::string cutfile = "";
+  std::string treefile = "";
+  bool outputfileSpecified = false;
+  bool cutfileSpecified = false;
+  bool treefileSpecified = false;
+  bool valueOnly = false;
+  bool binary = false;
+  ActiveSelection selection = HIGHEST_LABEL;
+  bool boykovKolmogorov = false;
+  bool preprocess = false;
+  bool reorder = false;
+  bool verify = false;
+  NodeOrder order = BFS_ORDER;
+  PageKind pages = TRANSPARENT_HUGE_PAGES;
+  unsigned int threadCount = std::thread::hardware_concurrency();
+};
+
+// Computes a maximum flow with the algorithm of the options
+template <typename G>
+void maxFlow(G& g, Options& o) {
+  if (o.boykovKolmogorov) {
+    g.boykovKolmogorov();
+  } else {
+    g.setSelection(o.selection);
+    g.pushRelabel(o.valueOnly);
+  }
+}
+
+// Solves the instance with the graph type G and writes the results
+template <typename G>
+void solve(Instance& instance, Reduction* reduction, Reordering* reordering, Options& o) {
+  Trace::Scope building("build graph");
+  G g(instance);
+  building.end();
+
+  if (reordering) {
+    // The flow is computed on the reordered graph and written for the
+    // original, reordering is done after the reduction
+    G reordered(reordering->getInstance());
+    maxFlow(reordered, o);
+    if (reduction) {
+      G reduced(reduction->getInstance());
+      reordering->expandFlow(reordered, reduced);
+      reduction->expandFlow(reduced, g);
+    } else {
+      reordering->expandFlow(reordered, g);
+    }
+  } else if (reduction) {
+    // The flow is computed on the reduced graph and written for the original
+    G reduced(reduction->getInstance());
+    maxFlow(reduced, o);
+    reduction->expandFlow(reduced, g);
+  } else {
+    maxFlow(g, o);
+  }
+
+  if (o.verify) {
+    Trace::Scope verifying("verify");
+    std::string error;
+    if (g.verifyFlow(error)) {
+      std::cerr << "Verification passed." << '\n';
+    } else {
+      std::cerr << "Verification failed: " << error << "." << '\n';
+    }
+  }
+
+  Trace::Scope writing("write output");
+  if (!o.outputfileSpecified) {
+    if (o.binary) {
+      g.exportFlowBinary(std::cout);
+    } else {
+      g.exportFlow(std::cout);
+    }
+  } else if (o.binary) {
+    std::fstream file(o.outputfile, std::ios_base::out | std::ios_base::binary);
+    g.exportFlowBinary(file);
+  } else {
+    std::fstream file(o.outputfile, std::ios_base::out);
+    g.exportFlow(file);
+  }
+  writing.end();
+
+  if (o.cutfileSpecified) {
+    std::fstream file(o.cutfile, std::ios_base::out);
+    g.exportCut(file);
+  }
+
+  if (o.treefileSpecified) {
+    Trace::Scope treeBuilding("gomory hu tree");
+    GomoryHuTree tree(g, o.threadCount);
+    std::fstream file(o.treefile, std::ios_base::out);
+    tree.exportTree(file);
+  }
+}
 
 // Main function
 int main(int argc, char** argv) {
-  std::string outputfile = "";
+  Options o;
   std::string filename = "";
   bool filenameSpecified = false;
-  bool outputfileSpecified = false;
   for (int i=1; i<argc; i++) {
     if (argv[i][0] == '-') {
-      // Output file can be specified
-      if (argv[i][1] == 'o') {
+      if (std::string(argv[i]) == "--verify") {
+        // Check the flow and the cut after the computation
+        o.verify = true;
+      } else if (std::string(argv[i]) == "--pages") {
+        // Pages of the large arrays: small, thp or huge
         if (i+1 < argc) {
-          outputfile = std::string(argv[i+1]);
-          outputfileSpecified = true;
+          std::string name(argv[i+1]);
+          if (name == "small") {
+            o.pages = SMALL_PAGES;
+          } else if (name == "thp") {
+            o.pages = TRANSPARENT_HUGE_PAGES;
+          } else if (name == "huge") {
+            o.pages = EXPLICIT_HUGE_PAGES;
+          } else {
+            std::cout << "Unknown page kind " << name << "." << '\n';
+            return 0;
+          }
+          i++;
+        }
+      } else if (std::string(argv[i]) == "--trace") {
+        // Write a timeline of the phases at exit
+        if (i+1 < argc) {
+          Trace::enable(argv[i+1]);
+          i++;
+        }
+      } else if (argv[i][1] == 'o') {
+        // Output file can be specified
+        if (i+1 < argc) {
+          o.outputfile = std::string(argv[i+1]);
+          o.outputfileSpecified = true;
+          i++;
+        }
+      } else if (argv[i][1] == 'c') {
+        // A file for the minimum cut can be specified
+        if (i+1 < argc) {
+          o.cutfile = std::string(argv[i+1]);
+          o.cutfileSpecified = true;
+          i++;
+        }
+      } else if (argv[i][1] == 'v') {
+        // Only compute the flow value (and the cut)
+        o.valueOnly = true;
+      } else if (argv[i][1] == 'b') {
+        // Write the flow in binary format
+        o.binary = true;
+      } else if (argv[i][1] == 'g') {
+        // A file for the Gomory-Hu tree can be specified
+        if (i+1 < argc) {
+          o.treefile = std::string(argv[i+1]);
+          o.treefileSpecified = true;
+          i++;
+        }
+      } else if (argv[i][1] == 'p') {
+        // Reduce the graph before computing the flow
+        o.preprocess = true;
+      } else if (argv[i][1] == 'r') {
+        // Renumber the nodes before computing the flow: bfs or rcm
+        if (i+1 < argc) {
+          std::string name(argv[i+1]);
+          if (name == "bfs") {
+            o.order = BFS_ORDER;
+          } else if (name == "rcm") {
+            o.order = RCM_ORDER;
+          } else {
+            std::cout << "Unknown node order " << name << "." << '\n';
+            return 0;
+          }
+          o.reorder = true;
+          i++;
+        }
+      } else if (argv[i][1] == 'a') {
+        // Max flow algorithm: pr (push relabel) or bk (Boykov-Kolmogorov)
+        if (i+1 < argc) {
+          std::string name(argv[i+1]);
+          if (name == "bk") {
+            o.boykovKolmogorov = true;
+          } else if (name == "pr") {
+            o.boykovKolmogorov = false;
+          } else {
+            std::cout << "Unknown algorithm " << name << "." << '\n';
+            return 0;
+          }
+          i++;
+        }
+      } else if (argv[i][1] == 's') {
+        // Strategy for choosing active nodes: highest, fifo or scaling
+        if (i+1 < argc) {
+          std::string name(argv[i+1]);
+          if (name == "fifo") {
+            o.selection = FIFO;
+          } else if (name == "scaling") {
+            o.selection = EXCESS_SCALING;
+          } else if (name == "highest") {
+            o.selection = HIGHEST_LABEL;
+          } else {
+            std::cout << "Unknown selection strategy " << name << "." << '\n';
+            return 0;
+          }
+          i++;
+        }
+      } else if (argv[i][1] == 'j') {
+        // Number of threads for parsing and the Gomory-Hu tree
+        if (i+1 < argc) {
+          try {
+            o.threadCount = std::stoul(argv[i+1]);
+          } catch (std::logic_error&) {
+            std::cout << "Invalid thread count " << argv[i+1] << "." << '\n';
+            return 0;
+          }
           i++;
         }
       }
@@ -36,17 +247,45 @@ int main(int argc, char** argv) {
     return 0;
   }
 
+  PageMemory::configure(o.pages, o.threadCount);
+  Trace::Scope loading("load instance");
+  Instance instance(filename, o.threadCount);
+  loading.end();
 
-  Graph g(filename);
-
-  g.pushRelabel();
-
-  if (!outputfileSpecified) {
-    g.exportFlow(std::cout);
+  // Use the narrowest capacity types the instance (and the reduced instance,
+  // whose merged edges may have larger capacities) fits into
+  Reduction* reduction = nullptr;
+  unsigned long long int maxCapacity = instance.getMaxCapacity();
+  unsigned long long int maxNodeCapacity = instance.getMaxNodeCapacity();
+  if (o.preprocess) {
+    Trace::Scope reducing("reduce");
+    reduction = new Reduction(instance, 0, 1);
+    maxCapacity = std::max(maxCapacity, reduction->getInstance().getMaxCapacity());
+    maxNodeCapacity = std::max(maxNodeCapacity, reduction->getInstance().getMaxNodeCapacity());
+  }
+  Reordering* reordering = nullptr;
+  if (o.reorder) {
+    Trace::Scope renumbering("reorder");
+    reordering = new Reordering(reduction ? reduction->getInstance() : instance, 0, 1, o.order);
+  }
+  bool smallFlow = maxNodeCapacity <= std::numeric_limits<unsigned int>::max();
+  if (maxCapacity <= std::numeric_limits<unsigned short int>::max()) {
+    if (smallFlow) {
+      solve<BasicGraph<unsigned short int, unsigned int>>(instance, reduction, reordering, o);
+    } else {
+      solve<BasicGraph<unsigned short int, unsigned long long int>>(instance, reduction, reordering, o);
+    }
+  } else if (maxCapacity <= std::numeric_limits<unsigned int>::max()) {
+    if (smallFlow) {
+      solve<BasicGraph<unsigned int, unsigned int>>(instance, reduction, reordering, o);
+    } else {
+      solve<BasicGraph<unsigned int, unsigned long long int>>(instance, reduction, reordering, o);
+    }
   } else {
-    std::fstream file(outputfile, std::ios_base::out);
-    g.exportFlow(file);
+    solve<BasicGraph<unsigned long long int, unsigned long long int>>(instance, reduction, reordering, o);
   }
+  delete reordering;
+  delete reduction;
 
   return 0;
 }
@@ -0,0 +1,268 @@
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+#include "Graph.h"
+#include "Trace.h"
+
+// Auction algorithm with epsilon scaling
+//
+// Every unassigned node i of the left partition bids for the right node j
+// with the lowest cost + price. The price of j rises by the difference to the
+// second lowest value plus epsilon, so that i is at most epsilon worse than
+// optimal at the new prices (epsilon complementary slackness). The previous
+// owner of j becomes unassigned. Once all nodes are assigned, the matching is
+// within n/2 * epsilon of the optimum. epsilon is divided by 4 after every
+// such phase, starting from a quarter of the largest cost.
+//
+// The costs are multiplied by n/2 + 1, a phase with epsilon 1 then gives an
+// optimal matching. For any prices, the sum over the left nodes of their
+// lowest cost + price minus the sum of all prices is a lower bound of the
+// optimum (a feasible solution of the dual problem).
+
+namespace {
+
+const unsigned int none = ~0u;
+
+// Rounds a / b up
+long long int divideUp(long long int a, long long int b) {
+  return a / b + (a % b > 0 ? 1 : 0);
+}
+
+}
+
+// Finds a perfect matching of the instance edges with the algorithm of
+// Hopcroft and Karp, matchEdge[i] is the edge of the left node i. Returns
+// false if there is none.
+template <typename Cost, typename Potential>
+bool BasicGraph<Cost, Potential>::anyPerfectMatching(std::vector<unsigned int>& matchEdge) {
+  unsigned int h = (getNodeCount()-2)/2;
+  const unsigned int unreached = ~0u;
+  matchEdge.assign(h, none);
+  // left node matched to the right node h+j
+  std::vector<unsigned int> matchRight(h, none);
+  std::vector<unsigned int> layer(h);
+  std::vector<unsigned int> next(h);
+  std::vector<unsigned int> queue;
+  std::vector<unsigned int> stack;
+
+  while (true) {
+    // Layers of the shortest alternating paths from the free left nodes
+    queue.clear();
+    for (unsigned int i = 0; i < h; i++) {
+      layer[i] = matchEdge[i] == none ? 0 : unreached;
+      if (matchEdge[i] == none) {
+        queue.push_back(i);
+      }
+    }
+    bool found = false;
+    for (unsigned int q = 0; q < queue.size(); q++) {
+      for (unsigned int e : nodes[queue[q]].getOutEdges()) {
+        unsigned int l = matchRight[heads[e]-h];
+        if (l == none) {
+          found = true;
+        } else if (layer[l] == unreached) {
+          layer[l] = layer[queue[q]] + 1;
+          queue.push_back(l);
+        }
+      }
+    }
+    if (!found) {
+      break;
+    }
+
+    // Disjoint augmenting paths along the layers, searched depth first
+    std::fill(next.begin(), next.end(), 0);
+    for (unsigned int root = 0; root < h; root++) {
+      if (matchEdge[root] != none) {
+        continue;
+      }
+      stack.assign(1, root);
+      while (!stack.empty()) {
+        unsigned int i = stack.back();
+        EdgeList& out = nodes[i].getOutEdges();
+        if (next[i] == out.size()) {
+          layer[i] = unreached;
+          stack.pop_back();
+          continue;
+        }
+        unsigned int l = matchRight[heads[out[next[i]++]]-h];
+        if (l == none) {
+          // every node of the stack takes the edge it came through
+          for (unsigned int a : stack) {
+            unsigned int e = nodes[a].getOutEdges()[next[a]-1];
+            matchEdge[a] = e;
+            matchRight[heads[e]-h] = a;
+          }
+          stack.clear();
+        } else if (layer[l] == layer[i] + 1) {
+          stack.push_back(l);
+        }
+      }
+    }
+  }
+
+  return std::find(matchEdge.begin(), matchEdge.end(), none) == matchEdge.end();
+}
+
+// Makes the given matching the active edges of the graph
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::setMatching(const std::vector<unsigned int>& matchEdge) {
+  for (unsigned int e = 0; e < getEdgeCount(); e++) {
+    if (activeEdges[e]) {
+      setActive(getEdge(e), false);
+    }
+  }
+  for (unsigned int e : matchEdge) {
+    setActive(getEdge(e), true);
+  }
+  for (unsigned int e : getNode(getNodeCount()-2).getOutEdges()) {
+    setActive(getEdge(e), true);
+  }
+  for (unsigned int e : getNode(getNodeCount()-1).getInEdges()) {
+    setActive(getEdge(e), true);
+  }
+}
+
+// Computes a perfect matching with the auction algorithm. The computation
+// stops after timeLimit seconds (if it is positive) or after the phase whose
+// epsilon is at most epsilon (exact for epsilon 0). The best matching found
+// becomes the active edges, the return value is a lower bound of the optimum.
+template <typename Cost, typename Potential>
+long long int BasicGraph<Cost, Potential>::auction(double timeLimit, double epsilon) {
+  auto start = std::chrono::steady_clock::now();
+  unsigned int h = (getNodeCount()-2)/2;
+
+  // Any perfect matching is the first result
+  std::vector<unsigned int> best;
+  Trace::Scope initial("hopcroft karp");
+  if (!anyPerfectMatching(best)) {
+    throw(std::runtime_error("auction: There is no perfect matching."));
+  }
+  long long int bestValue = 0;
+  for (unsigned int e : best) {
+    bestValue += costs[e];
+  }
+  initial.end();
+
+  long long int maxCost = 1;
+  for (unsigned int i = 0; i < h; i++) {
+    for (unsigned int e : nodes[i].getOutEdges()) {
+      maxCost = std::max(maxCost, std::abs(static_cast<long long int>(costs[e])));
+    }
+  }
+  // Prices stay below n/2 times the cost range, without room for that the
+  // costs are not scaled
+  long long int scale = h + 1;
+  if (maxCost > std::numeric_limits<long long int>::max() / 8 / scale / scale) {
+    scale = 1;
+  }
+  long long int finalEpsilon = std::max(1LL, static_cast<long long int>(std::floor(epsilon * scale)));
+  long long int eps = std::max(finalEpsilon, maxCost * scale / 4);
+
+  std::vector<long long int> price(h, 0);
+  std::vector<unsigned int> owner(h);
+  std::vector<unsigned int> assigned(h);
+  std::vector<unsigned int> unassigned;
+
+  // Lower bound of the dual solution of the current prices
+  auto dualBound = [&]() {
+    long long int sum = 0;
+    for (unsigned int i = 0; i < h; i++) {
+      long long int lowest = std::numeric_limits<long long int>::max();
+      for (unsigned int e : nodes[i].getOutEdges()) {
+        lowest = std::min(lowest, costs[e] * scale + price[heads[e]-h]);
+      }
+      sum += lowest;
+    }
+    for (unsigned int j = 0; j < h; j++) {
+      sum -= price[j];
+    }
+    return divideUp(sum, scale);
+  };
+  long long int lowerBound = dualBound();
+
+  bool timeout = false;
+  unsigned long long int bids = 0;
+  while (!timeout) {
+    Trace::Scope phase("auction phase");
+    std::fill(owner.begin(), owner.end(), none);
+    unassigned.clear();
+    for (unsigned int i = h; i > 0; i--) {
+      unassigned.push_back(i-1);
+    }
+
+    while (!unassigned.empty()) {
+      if (timeLimit > 0 && (++bids & 1023) == 0 &&
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() > timeLimit) {
+        timeout = true;
+        break;
+      }
+
+      // The lowest and second lowest cost + price over different right nodes
+      unsigned int i = unassigned.back();
+      unsigned int bestEdge = none;
+      unsigned int bestNode = none;
+      long long int lowest = std::numeric_limits<long long int>::max();
+      long long int second = std::numeric_limits<long long int>::max();
+      for (unsigned int e : nodes[i].getOutEdges()) {
+        unsigned int j = heads[e]-h;
+        long long int value = costs[e] * scale + price[j];
+        if (j == bestNode) {
+          if (value < lowest) {
+            lowest = value;
+            bestEdge = e;
+          }
+        } else if (value < lowest) {
+          second = lowest;
+          lowest = value;
+          bestEdge = e;
+          bestNode = j;
+        } else if (value < second) {
+          second = value;
+        }
+      }
+
+      // Bid, a node with a single neighbour raises the price by epsilon
+      price[bestNode] += (second == std::numeric_limits<long long int>::max() ? 0 : second - lowest) + eps;
+      unassigned.pop_back();
+      if (owner[bestNode] != none) {
+        unassigned.push_back(owner[bestNode]);
+      }
+      owner[bestNode] = i;
+      assigned[i] = bestEdge;
+    }
+    if (timeout) {
+      break;
+    }
+
+    long long int value = 0;
+    for (unsigned int i = 0; i < h; i++) {
+      value += costs[assigned[i]];
+    }
+    if (value < bestValue) {
+      bestValue = value;
+      best = assigned;
+    }
+    lowerBound = std::max(lowerBound, dualBound());
+    if (eps == finalEpsilon) {
+      break;
+    }
+    eps = std::max(finalEpsilon, eps / 4);
+  }
+  lowerBound = std::max(lowerBound, dualBound());
+
+  setMatching(best);
+  // The prices are no potential function of the matching
+  potentials.clear();
+  return lowerBound;
+}
+
+template long long int BasicGraph<short int, int>::auction(double, double);
+template long long int BasicGraph<short int, long long int>::auction(double, double);
+template long long int BasicGraph<int, int>::auction(double, double);
+template long long int BasicGraph<int, long long int>::auction(double, double);
+template long long int BasicGraph<long long int, long long int>::auction(double, double);
@@ -0,0 +1,261 @@
+#include <vector>
+#include <thread>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdlib>
+#include "Graph.h"
+#include "Simd.h"
+
+// Delta stepping
+//
+// Parallel version of the shortest path search of a phase. The tentative
+// distances (over the reduced costs, which are not negative) are kept in
+// buckets of width stepWidth. The lowest non-empty bucket is processed in
+// rounds: all its nodes are relaxed at the same time, nodes whose distance
+// drops into the same bucket are relaxed again in the next round. After the
+// bucket is empty, the distances of its nodes are final. The search stops
+// after the bucket of t.
+//
+// The relaxations of a round are split between the threads, which are kept
+// for all rounds of the phase. dist is lowered with an atomic compare and
+// swap minimum. The candidates are filtered against roundDist, the distances
+// at the start of the round, which is only written between rounds: dist is
+// never larger, so the filter lets through every edge which could lower it.
+// Every lowering is recorded with its edge, prev is set after the round from
+// the last lowering of every node.
+
+namespace {
+
+// Rounds with fewer nodes are relaxed by the calling thread only
+const unsigned int parallelThreshold = 1024;
+
+// Threads which run the parts of a round. They are started on the first round
+// which needs them and wait for the next round until destruction.
+class RoundWorkers {
+public:
+  RoundWorkers() { }
+  ~RoundWorkers() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    start.notify_all();
+    for (std::thread& th : threads) {
+      th.join();
+    }
+  }
+  RoundWorkers(const RoundWorkers&) = delete;
+  RoundWorkers& operator=(const RoundWorkers&) = delete;
+
+  // Runs task(p) for the parts p = 0, ..., parts-1, part 0 on the calling
+  // thread, and returns after all parts are done
+  void run(unsigned int parts, const std::function<void(unsigned int)>& task) {
+    while (threads.size() + 1 < parts) {
+      threads.push_back(std::thread(&RoundWorkers::work, this, threads.size() + 1, generation));
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      current = &task;
+      partCount = parts;
+      pending = parts - 1;
+      generation++;
+    }
+    start.notify_all();
+    task(0);
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending == 0; });
+  }
+private:
+  // Loop of the thread of the given part
+  void work(unsigned int part, unsigned long long int seen) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      start.wait(lock, [this, seen] { return stop || generation != seen; });
+      if (stop) {
+        return;
+      }
+      seen = generation;
+      if (part < partCount) {
+        const std::function<void(unsigned int)>* task = current;
+        lock.unlock();
+        (*task)(part);
+        lock.lock();
+        if (--pending == 0) {
+          done.notify_one();
+        }
+      }
+    }
+  }
+
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  std::condition_variable start;
+  std::condition_variable done;
+  const std::function<void(unsigned int)>* current = nullptr;
+  unsigned int partCount = 0;
+  unsigned int pending = 0;
+  unsigned long long int generation = 0;
+  bool stop = false;
+};
+
+}
+
+// Lowers dist[a] to d if d is smaller and records the lowering over the edge e
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::lowerDistance(unsigned int a, Potential d, unsigned int e, StepBuffers& buffers) {
+  Potential old = __atomic_load_n(&dist[a], __ATOMIC_RELAXED);
+  do {
+    if (old != -1 && d >= old) {
+      return;
+    }
+  } while (!__atomic_compare_exchange_n(&dist[a], &old, d, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+  if (old == -1) {
+    buffers.reached.push_back(a);
+  }
+  buffers.improved.push_back(Lowering{a, e, d});
+}
+
+// Relaxes the residual edges of the nodes of the list
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::relaxNodes(const unsigned int* list, unsigned int count,
+  std::vector<Potential>& potential, StepBuffers& buffers) {
+  for (unsigned int i = 0; i < count; i++) {
+    unsigned int a = list[i];
+    EdgeList& out = nodes[a].getOutEdges();
+    EdgeList& in = nodes[a].getInEdges();
+    buffers.candPos.resize(std::max(out.size(), in.size()));
+    buffers.candDist.resize(buffers.candPos.size());
+
+    // tentative distances over the edges are dist + redCost, tails[e] resp.
+    // heads[e] is the active node
+    Potential base = __atomic_load_n(&dist[a], __ATOMIC_RELAXED) + potential[a];
+
+    unsigned int found = relaxCandidates(out.data(), out.size(), heads.data(), costs.data(), potential.data(),
+      roundDist.data(), base, 1, buffers.candPos.data(), buffers.candDist.data());
+    for (unsigned int j = 0; j < found; j++) {
+      unsigned int e = out[buffers.candPos[j]];
+      if (!activeEdges[e]) {
+        lowerDistance(heads[e], buffers.candDist[j], e, buffers);
+      }
+    }
+
+    found = relaxCandidates(in.data(), in.size(), tails.data(), costs.data(), potential.data(),
+      roundDist.data(), base, -1, buffers.candPos.data(), buffers.candDist.data());
+    for (unsigned int j = 0; j < found; j++) {
+      unsigned int e = in[buffers.candPos[j]];
+      if (activeEdges[e]) {
+        lowerDistance(tails[e], buffers.candDist[j], e, buffers);
+      }
+    }
+  }
+}
+
+// Augments along a shortest path from s to t and updates the potential
+// function like dijkstra, the search is done by delta stepping with
+// threadCount threads
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::deltaStepping(std::vector<Potential>& potential, unsigned int threadCount) {
+  unsigned int s = getNodeCount()-2;
+  unsigned int t = getNodeCount()-1;
+  threadCount = std::max(1u, threadCount);
+
+  prepareSearch();
+  if (roundDist.size() != getNodeCount()) {
+    roundDist.assign(getNodeCount(), -1);
+    stamp.assign(getNodeCount(), 0);
+    round = 0;
+  }
+  stepBuffers.resize(threadCount);
+
+  // The buckets are as wide as the largest absolute edge cost
+  if (stepWidth == 0) {
+    stepWidth = 1;
+    for (unsigned int e = 0; e < getEdgeCount(); e++) {
+      stepWidth = std::max(stepWidth, static_cast<Potential>(std::abs(static_cast<long long int>(costs[e]))));
+    }
+  }
+
+  touched.clear();
+  dist[s] = 0;
+  roundDist[s] = 0;
+  touched.push_back(s);
+  buckets.resize(std::max<std::size_t>(buckets.size(), 1));
+  buckets[0].push_back(s);
+
+  RoundWorkers workers;
+  std::size_t used = 1;
+  for (std::size_t i = 0; i < used; i++) {
+    // all buckets up to the one of t are done
+    if (dist[t] != -1 && static_cast<std::size_t>(dist[t] / stepWidth) < i) {
+      break;
+    }
+
+    while (!buckets[i].empty()) {
+      // Outdated entries and duplicates are removed
+      round++;
+      if (round == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        round = 1;
+      }
+      frontier.clear();
+      for (unsigned int a : buckets[i]) {
+        if (stamp[a] != round && static_cast<std::size_t>(dist[a] / stepWidth) == i) {
+          stamp[a] = round;
+          frontier.push_back(a);
+        }
+      }
+      buckets[i].clear();
+
+      unsigned int parts = frontier.size() < parallelThreshold ? 1 : threadCount;
+      unsigned int partSize = (frontier.size() + parts - 1) / parts;
+      auto relaxPart = [&](unsigned int p) {
+        unsigned int first = std::min<std::size_t>(p * partSize, frontier.size());
+        unsigned int last = std::min<std::size_t>(first + partSize, frontier.size());
+        relaxNodes(frontier.data() + first, last - first, potential, stepBuffers[p]);
+      };
+      if (parts == 1) {
+        relaxPart(0);
+      } else {
+        workers.run(parts, relaxPart);
+      }
+
+      // The last lowering of a node gives its new distance and prev, the node
+      // goes into the bucket of the new distance
+      for (unsigned int p = 0; p < parts; p++) {
+        touched.insert(touched.end(), stepBuffers[p].reached.begin(), stepBuffers[p].reached.end());
+        for (const Lowering& l : stepBuffers[p].improved) {
+          if (l.dist != dist[l.node]) {
+            continue;
+          }
+          prev[l.node] = l.edge;
+          roundDist[l.node] = l.dist;
+          std::size_t j = l.dist / stepWidth;
+          if (j >= buckets.size()) {
+            buckets.resize(j + 1);
+          }
+          used = std::max(used, j + 1);
+          buckets[j].push_back(l.node);
+        }
+        stepBuffers[p].reached.clear();
+        stepBuffers[p].improved.clear();
+      }
+    }
+  }
+  for (std::size_t i = 0; i < used; i++) {
+    buckets[i].clear();
+  }
+  for (unsigned int a : touched) {
+    roundDist[a] = -1;
+  }
+
+  augment(potential);
+}
+
+template void BasicGraph<short int, int>::deltaStepping(std::vector<int>&, unsigned int);
+template void BasicGraph<short int, long long int>::deltaStepping(std::vector<long long int>&, unsigned int);
+template void BasicGraph<int, int>::deltaStepping(std::vector<int>&, unsigned int);
+template void BasicGraph<int, long long int>::deltaStepping(std::vector<long long int>&, unsigned int);
+template void BasicGraph<long long int, long long int>::deltaStepping(std::vector<long long int>&, unsigned int);
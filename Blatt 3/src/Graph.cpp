@@ -3,125 +3,152 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
 #include "Graph.h"
+#include "Simd.h"
+#include "Writer.h"
+#include "Trace.h"
 
-Graph::Edge::Edge(unsigned int a, unsigned int b, unsigned int id, int cost) : a(a), b(b), id(id), cost(cost), active(false) { }
+template <typename Cost, typename Potential>
+BasicGraph<Cost, Potential>::Edge::Edge(BasicGraph* g, unsigned int id) : g(g), id(id) { }
 
-unsigned int Graph::Edge::getId() {
+template <typename Cost, typename Potential>
+unsigned int BasicGraph<Cost, Potential>::Edge::getId() {
   return id;
 }
 
-unsigned int Graph::Edge::getA() {
-  return a;
+template <typename Cost, typename Potential>
+unsigned int BasicGraph<Cost, Potential>::Edge::getA() {
+  return g->tails[id];
 }
 
-unsigned int Graph::Edge::getB() {
-  return b;
+template <typename Cost, typename Potential>
+unsigned int BasicGraph<Cost, Potential>::Edge::getB() {
+  return g->heads[id];
 }
 
-bool Graph::Edge::isActive() {
-  return active;
+template <typename Cost, typename Potential>
+bool BasicGraph<Cost, Potential>::Edge::isActive() {
+  return g->activeEdges[id];
 }
 
-int Graph::Edge::getCost() {
-  return cost;
+template <typename Cost, typename Potential>
+Cost BasicGraph<Cost, Potential>::Edge::getCost() {
+  return g->costs[id];
 }
 
-void Graph::setActive(Edge& e, bool active) {
-  unsigned int oldflow = static_cast<unsigned int>(e.isActive());
-  e.active = active;
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::setActive(Edge e, bool act) {
+  unsigned int oldflow = static_cast<unsigned int>(activeEdges[e.getId()]);
+  activeEdges[e.getId()] = act;
 
-  Node& a = getNode(e.getA());
-  Node& b = getNode(e.getB());
+  Node& a = getNode(tails[e.getId()]);
+  Node& b = getNode(heads[e.getId()]);
 
   a.outFlow -= oldflow;
-  a.outFlow += active;
+  a.outFlow += act;
   b.inFlow -= oldflow;
-  b.inFlow += active;
+  b.inFlow += act;
 }
 
-Graph::Node::Node(unsigned int id) : id(id) { }
+template <typename Cost, typename Potential>
+BasicGraph<Cost, Potential>::Node::Node(unsigned int id, Arena& arena) : id(id), inEdges(ArenaAllocator<unsigned int>(arena)), outEdges(ArenaAllocator<unsigned int>(arena)) { }
 
-unsigned int Graph::Node::getId() {
+template <typename Cost, typename Potential>
+unsigned int BasicGraph<Cost, Potential>::Node::getId() {
   return id;
 }
 
-void Graph::addOutEdge(Graph::Node& n, unsigned int e) {
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::addOutEdge(Node& n, unsigned int e) {
   n.outEdges.push_back(e);
-  n.outFlow += static_cast<unsigned int>(getEdge(e).isActive());
+  n.outFlow += static_cast<unsigned int>(activeEdges[e]);
 }
 
-void Graph::addInEdge(Graph::Node& n, unsigned int e) {
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::addInEdge(Node& n, unsigned int e) {
   n.inEdges.push_back(e);
-  n.inFlow += static_cast<unsigned int>(getEdge(e).isActive());
+  n.inFlow += static_cast<unsigned int>(activeEdges[e]);
 }
 
 // Gets the edges going out
-std::vector<unsigned int>& Graph::Node::getOutEdges() {
+template <typename Cost, typename Potential>
+typename BasicGraph<Cost, Potential>::EdgeList& BasicGraph<Cost, Potential>::Node::getOutEdges() {
   return outEdges;
 }
 
 // Gets the edges going in
-std::vector<unsigned int>& Graph::Node::getInEdges() {
+template <typename Cost, typename Potential>
+typename BasicGraph<Cost, Potential>::EdgeList& BasicGraph<Cost, Potential>::Node::getInEdges() {
   return inEdges;
 }
 
 // Gets the flow out of the edge
-unsigned int Graph::Node::getOutFlow() {
+template <typename Cost, typename Potential>
+unsigned int BasicGraph<Cost, Potential>::Node::getOutFlow() {
   return outFlow;
 }
 
 // Gets the flow into the edge
-unsigned int Graph::Node::getInFlow() {
+template <typename Cost, typename Potential>
+unsigned int BasicGraph<Cost, Potential>::Node::getInFlow() {
   return inFlow;
 }
 
 // Constructor, initializes the graph
-Graph::Graph(unsigned int nc) {
+template <typename Cost, typename Potential>
+BasicGraph<Cost, Potential>::BasicGraph(unsigned int nc) {
   nodeCount = nc;
 
   // Add node objects to nodes vector
   nodes.reserve(nc);
   for (unsigned int i = 0; i < nc; i++) {
-    nodes.push_back(Node(i));
+    nodes.push_back(Node(i, graphArena));
   }
+
+  costs.push_back(0);
 }
 
 // Parses a graph file and constructs the graph
-Graph::Graph(std::string filename) {
-  std::fstream file(filename, std::ios_base::in);
+template <typename Cost, typename Potential>
+BasicGraph<Cost, Potential>::BasicGraph(std::string filename) {
+  Instance instance(filename);
+  load(instance);
+}
 
-  // Check if file is open
-  if (!file.is_open()) {
-    nodeCount = 0;
-    throw(std::runtime_error("File could not be opened."));
-    return;
+// Constructs the graph of an instance, whose costs have to fit into the cost
+// type of the graph
+template <typename Cost, typename Potential>
+BasicGraph<Cost, Potential>::BasicGraph(Instance& instance) {
+  if (instance.getMaxAbsCost() > static_cast<unsigned long long int>(std::numeric_limits<Cost>::max())) {
+    throw(std::runtime_error("The costs of the instance are too large for the graph."));
   }
+  load(instance);
+}
 
-  // Set Node Count of the Graph
-  unsigned int nc;
-  file >> nc;
-  if (nc%2 != 0) {
-    throw(std::runtime_error("Tried to load an evenly partitioned bipartite graph with odd node count."));
-    return;
-  }
+// Builds the graph of an instance
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::load(Instance& instance) {
+  unsigned int nc = instance.getNodeCount();
   nodeCount = nc + 2; // id of s: getNodeCount-2, id of t: getNodeCount-1
 
   // Add node objects to nodes vector
   nodes.reserve(nodeCount);
   for (unsigned int i = 0; i < nodeCount; i++) {
-    nodes.push_back(Node(i));
+    nodes.push_back(Node(i, graphArena));
   }
 
-  // Parses edges from the file
-  unsigned int a, b;
-  int cost;
-  while (file >> a >> b >> cost) {
-    if (a>=nc/2 || b<nc/2) {
-      throw(std::runtime_error("Tried to add an edge between nodes of the wrong partition."));
-      return;
-    }
-    addEdge(a, b, cost);
+  unsigned int m = instance.getEdgeCount() + nc;
+  tails.reserve(m);
+  heads.reserve(m);
+  costs.reserve(m + 1);
+  costs.push_back(0);
+
+  for (unsigned int e = 0; e < instance.getEdgeCount(); e++) {
+    addEdge(instance.getTail(e), instance.getHead(e), instance.getCost(e));
   }
 
   // Adds edges from s to all nodes of the left partition and from all nodes of
@@ -135,25 +162,34 @@ Graph::Graph(std::string filename) {
 }
 
 // Adds an edge to the graph
-void Graph::addEdge(unsigned int a, unsigned int b, int cost) {
-  Edge e(a, b, edges.size(), cost);
-  edges.push_back(e);
-  addOutEdge(getNode(a), e.getId());
-  addInEdge(getNode(b), e.getId());
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::addEdge(unsigned int a, unsigned int b, Cost cost) {
+  unsigned int id = getEdgeCount();
+  tails.push_back(a);
+  heads.push_back(b);
+  // the last element is the padding
+  costs.back() = cost;
+  costs.push_back(0);
+  activeEdges.push_back(false);
+  addOutEdge(getNode(a), id);
+  addInEdge(getNode(b), id);
 }
 
 // Gets the node count of the graph
-unsigned int Graph::getNodeCount() {
+template <typename Cost, typename Potential>
+unsigned int BasicGraph<Cost, Potential>::getNodeCount() {
   return nodeCount;
 }
 
 // Gets the edge count of the graph
-unsigned int Graph::getEdgeCount() {
-  return edges.size();
+template <typename Cost, typename Potential>
+unsigned int BasicGraph<Cost, Potential>::getEdgeCount() {
+  return tails.size();
 }
 
 // Gets a node in the graph
-Graph::Node& Graph::getNode(unsigned int a) {
+template <typename Cost, typename Potential>
+typename BasicGraph<Cost, Potential>::Node& BasicGraph<Cost, Potential>::getNode(unsigned int a) {
   if (a > getNodeCount()) {
     throw(std::runtime_error("Tried to get non-existing node."));
   }
@@ -161,99 +197,201 @@ Graph::Node& Graph::getNode(unsigned int a) {
 }
 
 // Gets an edge in the graph
-Graph::Edge& Graph::getEdge(unsigned int a) {
+template <typename Cost, typename Potential>
+typename BasicGraph<Cost, Potential>::Edge BasicGraph<Cost, Potential>::getEdge(unsigned int a) {
   if (a > getEdgeCount()) {
     throw(std::runtime_error("Tried to get non-existing edge."));
   }
-  return edges[a];
+  return Edge(this, a);
+}
+
+// Gets the tail nodes of all edges, indexed by edge id
+template <typename Cost, typename Potential>
+typename BasicGraph<Cost, Potential>::template ArrayView<unsigned int> BasicGraph<Cost, Potential>::getTails() {
+  return ArrayView<unsigned int>(tails.data(), tails.size());
+}
+
+// Gets the head nodes of all edges, indexed by edge id
+template <typename Cost, typename Potential>
+typename BasicGraph<Cost, Potential>::template ArrayView<unsigned int> BasicGraph<Cost, Potential>::getHeads() {
+  return ArrayView<unsigned int>(heads.data(), heads.size());
+}
+
+// Gets the costs of all edges, indexed by edge id
+template <typename Cost, typename Potential>
+typename BasicGraph<Cost, Potential>::template ArrayView<Cost> BasicGraph<Cost, Potential>::getCosts() {
+  return ArrayView<Cost>(costs.data(), getEdgeCount());
 }
 
-void Graph::exportMatching(std::ostream& out) {
+// Gets the bitset of active (matched) edges, indexed by edge id
+template <typename Cost, typename Potential>
+const std::vector<bool>& BasicGraph<Cost, Potential>::getActive() {
+  return activeEdges;
+}
+
+// Collects the matching edges (all active edges not adjacent to s or t) and
+// returns the value of the matching
+template <typename Cost, typename Potential>
+long long int BasicGraph<Cost, Potential>::getMatching(std::vector<unsigned int>& matching) {
   long long int value = 0;
+  matching.clear();
   for (unsigned int e=0; e<getEdgeCount(); e++) {
-    if (getEdge(e).isActive() && getEdge(e).getA() != getNodeCount()-2 && getEdge(e).getB() != getNodeCount()-1) {
-      value += getEdge(e).getCost();
+    if (activeEdges[e] && tails[e] != getNodeCount()-2 && heads[e] != getNodeCount()-1) {
+      value += costs[e];
+      matching.push_back(e);
     }
   }
-  out << value << '\n';
+  return value;
+}
 
-  for (unsigned int e=0; e<getEdgeCount(); e++) {
-    if (getEdge(e).isActive() && getEdge(e).getA() != getNodeCount()-2 && getEdge(e).getB() != getNodeCount()-1) {
-      out << getEdge(e).getA() << ' ' << getEdge(e).getB() << '\n';
-    }
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::exportMatching(std::ostream& out) {
+  std::vector<unsigned int> matching;
+  long long int value = getMatching(matching);
+
+  Writer w(out);
+  w.writeInt(value);
+  w.writeChar('\n');
+  for (unsigned int e : matching) {
+    w.writeUInt(tails[e]);
+    w.writeChar(' ');
+    w.writeUInt(heads[e]);
+    w.writeChar('\n');
   }
+}
 
+// Exports the matching in binary format (little endian):
+// "EDMMATC1", the value (64 bit, two's complement), the number k of matching
+// edges (32 bit) and k pairs of node ids (32 bit each)
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::exportMatchingBinary(std::ostream& out) {
+  std::vector<unsigned int> matching;
+  long long int value = getMatching(matching);
+
+  Writer w(out);
+  w.writeBytes("EDMMATC1", 8);
+  w.writeUInt64(static_cast<unsigned long long int>(value));
+  w.writeUInt32(matching.size());
+  for (unsigned int e : matching) {
+    w.writeUInt32(tails[e]);
+    w.writeUInt32(heads[e]);
+  }
 }
 
 // Returns the reduced cost
-long long int redCost(Graph::Edge& e, std::vector<long long int>& potential) {
+template <typename G>
+typename G::PotentialType redCost(typename G::Edge e, std::vector<typename G::PotentialType>& potential) {
   return e.getCost() + potential[e.getA()] - potential[e.getB()];
 }
 
-// Gets the next active node for dijkstra algorithm
-unsigned int getNextActive(std::list<unsigned int>& open, std::vector<long long int>& dist) {
-  unsigned int res;
+// Augments along the shortest path from s to t and updates the potential
+// function. The search stops as soon as t is settled, see augment for the
+// potential update.
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::dijkstra(std::vector<Potential>& potential) {
+  unsigned int s = getNodeCount()-2;
+  unsigned int t = getNodeCount()-1;
+  std::greater<std::pair<Potential, unsigned int>> later;
+
+  prepareSearch();
+  touched.clear();
+  open.clear();
+  dist[s] = 0;
+  touched.push_back(s);
+  open.push_back(std::make_pair(0, s));
 
-  // the next element from the open list
-  auto minOpen = open.begin();
-  for (auto it = open.begin(); it != open.end(); ++it) {
-    if (dist[*it] < dist[*minOpen]) {
-      minOpen = it;
+  while (open.size() > 0) {
+    std::pop_heap(open.begin(), open.end(), later);
+    std::pair<Potential, unsigned int> next = open.back();
+    open.pop_back();
+    // skip outdated entries
+    if (next.first != dist[next.second]) {
+      continue;
+    }
+    if (next.second == t) {
+      break;
     }
-  }
-
-  res = *minOpen;
-  open.erase(minOpen);
-
-  return res;
-}
-
-// Augments along the shortest path from s to t and updates the potential function
-void Graph::dijkstra(std::vector<long long int>& potential) {
-  // Stores all the distances from s to any node
-  std::vector<long long int> dist(getNodeCount(), -1);
-  dist[getNodeCount()-2] = 0;
-
-  // Stores the previous edges
-  std::vector<long long int> prev(getNodeCount(), -1);
-
-  // Stores open nodes in a list
-  std::list<unsigned int> open;
-  open.push_back(getNodeCount()-2);
 
-  while (open.size() > 0) {
-    Node& active = getNode(getNextActive(open, dist));
-    for (unsigned int e : active.getOutEdges()) {
-      if (!getEdge(e).isActive() && (dist[active.getId()] + redCost(getEdge(e), potential) < dist[getEdge(e).getB()] || dist[getEdge(e).getB()] == -1)) {
-        if (dist[getEdge(e).getB()] == -1) {
-          open.push_back(getEdge(e).getB());
+    Node& active = getNode(next.second);
+    EdgeList& out = active.getOutEdges();
+    EdgeList& in = active.getInEdges();
+    candPos.resize(std::max(out.size(), in.size()));
+    candDist.resize(candPos.size());
+
+    // tentative distances over the edges are dist + redCost, tails[e] resp.
+    // heads[e] is the active node
+    Potential base = dist[active.getId()] + potential[active.getId()];
+
+    unsigned int found = relaxCandidates(out.data(), out.size(), heads.data(), costs.data(), potential.data(),
+      dist.data(), base, 1, candPos.data(), candDist.data());
+    for (unsigned int i = 0; i < found; i++) {
+      unsigned int e = out[candPos[i]];
+      unsigned int b = heads[e];
+      Potential d = candDist[i];
+      if (!activeEdges[e] && (d < dist[b] || dist[b] == -1)) {
+        if (dist[b] == -1) {
+          touched.push_back(b);
         }
-        prev[getEdge(e).getB()] = e;
-        dist[getEdge(e).getB()] = dist[active.getId()] + redCost(getEdge(e), potential);
+        prev[b] = e;
+        dist[b] = d;
+        open.push_back(std::make_pair(d, b));
+        std::push_heap(open.begin(), open.end(), later);
       }
     }
-    for (unsigned int e : active.getInEdges()) {
-      if (getEdge(e).isActive() && (dist[active.getId()] - redCost(getEdge(e), potential) < dist[getEdge(e).getA()] || dist[getEdge(e).getA()] == -1)) {
-        if (dist[getEdge(e).getA()] == -1) {
-          open.push_back(getEdge(e).getA());
+
+    found = relaxCandidates(in.data(), in.size(), tails.data(), costs.data(), potential.data(),
+      dist.data(), base, -1, candPos.data(), candDist.data());
+    for (unsigned int i = 0; i < found; i++) {
+      unsigned int e = in[candPos[i]];
+      unsigned int a = tails[e];
+      Potential d = candDist[i];
+      if (activeEdges[e] && (d < dist[a] || dist[a] == -1)) {
+        if (dist[a] == -1) {
+          touched.push_back(a);
         }
-        prev[getEdge(e).getA()] = e;
-        dist[getEdge(e).getA()] = dist[active.getId()] - redCost(getEdge(e), potential);
+        prev[a] = e;
+        dist[a] = d;
+        open.push_back(std::make_pair(d, a));
+        std::push_heap(open.begin(), open.end(), later);
       }
     }
   }
 
-  // Finished pathfinding here
+  augment(potential);
+}
+
+// Allocates the search state on the first use, between phases dist is -1 for
+// every node
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::prepareSearch() {
+  if (dist.size() != getNodeCount()) {
+    dist.assign(getNodeCount(), -1);
+    prev.assign(getNodeCount(), 0);
+  }
+}
+
+// Augments along the path to t found by a shortest path search and updates
+// the potential function. The search has to leave the distances of all
+// touched nodes which are closer than t final, the potential of every node is
+// shifted by -dist(t) compared to adding the distances, which does not change
+// any reduced cost.
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::augment(std::vector<Potential>& potential) {
+  unsigned int s = getNodeCount()-2;
+  unsigned int t = getNodeCount()-1;
 
   // Check if t is reachable
-  if (dist[getNodeCount()-1] == -1) {
+  if (dist[t] == -1) {
+    for (unsigned int a : touched) {
+      dist[a] = -1;
+    }
     throw(std::runtime_error("dijkstra: Failed to find s-t-path. Therefore, there is no perfect matching."));
     return;
   }
 
   // Augment along the path
-  unsigned int tmp = getNodeCount()-1;
-  while (tmp != getNodeCount()-2) {
+  unsigned int tmp = t;
+  while (tmp != s) {
     setActive(getEdge(prev[tmp]), !getEdge(prev[tmp]).isActive());
     if (tmp == getEdge(prev[tmp]).getA()) {
       tmp = getEdge(prev[tmp]).getB();
@@ -262,18 +400,21 @@ void Graph::dijkstra(std::vector<long long int>& potential) {
     }
   }
 
-  // Update potential
-  for (unsigned int i=0; i<getNodeCount(); i++) {
-    if (dist[i] != -1) {
-      potential[i] += dist[i];
-    } else {
-      potential[i] += dist[getNodeCount()-1];
+  // Update potential of the settled nodes (all nodes closer than t) and reset
+  // the touched nodes for the next phase
+  Potential distT = dist[t];
+  for (unsigned int a : touched) {
+    if (dist[a] < distT) {
+      potential[a] += dist[a] - distT;
     }
+    dist[a] = -1;
   }
 }
 
-void Graph::perfectMatching() {
-  std::vector<long long int> potential(getNodeCount(), 0);
+template <typename Cost, typename Potential>
+void BasicGraph<Cost, Potential>::perfectMatching(bool useDeltaStepping, unsigned int threadCount) {
+  std::vector<Potential>& potential = potentials;
+  potential.assign(getNodeCount(), 0);
   // Set up initial potential
   for (unsigned int e=0; e<getEdgeCount(); e++) {
     if (getEdge(e).getCost() < potential[getEdge(e).getB()] && getEdge(e).getB() != getNodeCount()-1) {
@@ -287,6 +428,59 @@ void Graph::perfectMatching() {
   }
 
   while (getNode(getNodeCount()-2).getOutFlow() != (getNodeCount()-2)/2) {
-    dijkstra(potential);
+    Trace::Scope phase(useDeltaStepping ? "delta stepping phase" : "dijkstra phase");
+    if (useDeltaStepping) {
+      deltaStepping(potential, threadCount);
+    } else {
+      dijkstra(potential);
+    }
   }
 }
+
+// Checks the active edges in O(n + m): every left and right node has exactly
+// one matching edge. After perfectMatching, the potential function is also a
+// certificate of optimality: the reduced costs c(e) + p(a) - p(b) of all
+// instance edges are not negative and 0 on the matching edges, so -p on the
+// left and p on the right nodes is a dual solution of the same value. On
+// failure, error gets the reason.
+template <typename Cost, typename Potential>
+bool BasicGraph<Cost, Potential>::verifyMatching(std::string& error) {
+  unsigned int s = getNodeCount()-2;
+  unsigned int t = getNodeCount()-1;
+  std::vector<unsigned int> degree(s, 0);
+  for (unsigned int e=0; e<getEdgeCount(); e++) {
+    if (tails[e] == s || heads[e] == t) {
+      continue;
+    }
+    long long int reducedCost = 0;
+    if (!potentials.empty()) {
+      reducedCost = static_cast<long long int>(costs[e]) + potentials[tails[e]] - potentials[heads[e]];
+    }
+    if (reducedCost < 0) {
+      error = "Edge " + std::to_string(e) + " has a negative reduced cost";
+      return false;
+    }
+    if (activeEdges[e]) {
+      if (reducedCost != 0) {
+        error = "Matching edge " + std::to_string(e) + " has a positive reduced cost";
+        return false;
+      }
+      degree[tails[e]]++;
+      degree[heads[e]]++;
+    }
+  }
+  for (unsigned int i=0; i<s; i++) {
+    if (degree[i] != 1) {
+      error = "Node " + std::to_string(i) + " is covered by " + std::to_string(degree[i]) + " matching edges";
+      return false;
+    }
+  }
+  return true;
+}
+
+// Instantiations for 16, 32 and 64 bit costs
+template class BasicGraph<short int, int>;
+template class BasicGraph<short int, long long int>;
+template class BasicGraph<int, int>;
+template class BasicGraph<int, long long int>;
+template class BasicGraph<long long int, long long int>;
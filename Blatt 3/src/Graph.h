@@ -4,71 +4,173 @@
 #include <vector>
 #include <list>
 #include <string>
+#include <utility>
 #include <iostream>
+#include "Arena.h"
+#include "PageMemory.h"
+#include "Instance.h"
 
-// Class for a graph
-class Graph {
+// Class for a graph with edge costs of type Cost. Distances and potentials are
+// of type Potential, which has to be large enough for path lengths in the
+// graph. Instantiations exist for signed 16, 32 and 64 bit costs, see the end
+// of Graph.cpp.
+template <typename Cost, typename Potential>
+class BasicGraph {
 public:
   class Edge;
   class Node;
 
-  void setActive(Edge& e, bool active);
+  typedef Cost CostType;
+  typedef Potential PotentialType;
+
+  // Adjacency list of a node, allocated from the arena of the graph
+  typedef ArenaVector<unsigned int> EdgeList;
+
+  // Read-only view of a contiguous array of edge attributes
+  template <typename T>
+  class ArrayView {
+  public:
+    ArrayView(const T* data, unsigned int size) : ptr(data), count(size) { }
+    const T& operator[](unsigned int i) const { return ptr[i]; }
+    const T* data() const { return ptr; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+    unsigned int size() const { return count; }
+  private:
+    const T* ptr;
+    unsigned int count;
+  };
+
+  void setActive(Edge e, bool active);
   void addOutEdge(Node& n, unsigned int e);
   void addInEdge(Node& n, unsigned int e);
 
-  // An edge in the graph between two nodes
+  // A handle to an edge, the edge data itself is stored in the edge arrays
+  // of the graph
   class Edge {
   public:
-    Edge(unsigned int a, unsigned int b, unsigned int id, int cost);
+    Edge(BasicGraph* g, unsigned int id);
     unsigned int getId();
     unsigned int getA();
     unsigned int getB();
     bool isActive();
-    int getCost();
-    friend void Graph::setActive(Edge& e, bool active);
+    Cost getCost();
   private:
-    unsigned int a;
-    unsigned int b;
+    BasicGraph* g;
     unsigned int id;
-    int cost;
-    bool active;
   };
 
   // A node in the graph
   class Node {
   public:
-    Node(unsigned int id);
+    Node(unsigned int id, Arena& arena);
     unsigned int getId();
-    friend void Graph::addOutEdge(Node& n, unsigned int e);
-    friend void Graph::addInEdge(Node& n, unsigned int e);
-    std::vector<unsigned int>& getOutEdges();
-    std::vector<unsigned int>& getInEdges();
+    friend void BasicGraph::addOutEdge(Node& n, unsigned int e);
+    friend void BasicGraph::addInEdge(Node& n, unsigned int e);
+    EdgeList& getOutEdges();
+    EdgeList& getInEdges();
     unsigned int getOutFlow();
     unsigned int getInFlow();
-    friend void Graph::setActive(Edge& e, bool active);
+    friend void BasicGraph::setActive(Edge e, bool active);
   private:
     unsigned int id;
     unsigned int inFlow = 0;
     unsigned int outFlow = 0;
-    std::vector<unsigned int> inEdges;
-    std::vector<unsigned int> outEdges;
+    EdgeList inEdges;
+    EdgeList outEdges;
   };
 
-  Graph(unsigned int nodeCount);
-  Graph(std::string filename);
-  void addEdge(unsigned int a, unsigned int b, int cost);
+  BasicGraph(unsigned int nodeCount);
+  BasicGraph(std::string filename);
+  BasicGraph(Instance& instance);
+  void addEdge(unsigned int a, unsigned int b, Cost cost);
   unsigned int getNodeCount();
   unsigned int getEdgeCount();
   Node& getNode(unsigned int a);
-  Edge& getEdge(unsigned int a);
+  Edge getEdge(unsigned int a);
+  ArrayView<unsigned int> getTails();
+  ArrayView<unsigned int> getHeads();
+  ArrayView<Cost> getCosts();
+  const std::vector<bool>& getActive();
+  long long int getMatching(std::vector<unsigned int>& matching);
   void exportMatching(std::ostream& out);
-  void dijkstra(std::vector<long long int>& potential);
-  void perfectMatching();
-  friend std::ostream& operator<<(std::ostream& out, const Graph& o);
+  void exportMatchingBinary(std::ostream& out);
+  void dijkstra(std::vector<Potential>& potential);
+  void deltaStepping(std::vector<Potential>& potential, unsigned int threadCount);
+  void perfectMatching(bool useDeltaStepping = false, unsigned int threadCount = 1);
+  long long int auction(double timeLimit, double epsilon);
+  bool verifyMatching(std::string& error);
 private:
+  // A distance of a node lowered by delta stepping and the edge it was
+  // lowered over
+  struct Lowering {
+    unsigned int node;
+    unsigned int edge;
+    Potential dist;
+  };
+
+  // Buffers of one thread of delta stepping
+  struct StepBuffers {
+    // distances lowered in the round resp. nodes which were reached for the
+    // first time
+    std::vector<Lowering> improved;
+    std::vector<unsigned int> reached;
+    std::vector<unsigned int> candPos;
+    std::vector<Potential> candDist;
+  };
+
+  void load(Instance& instance);
+  void prepareSearch();
+  void augment(std::vector<Potential>& potential);
+  void relaxNodes(const unsigned int* list, unsigned int count, std::vector<Potential>& potential, StepBuffers& buffers);
+  void lowerDistance(unsigned int a, Potential d, unsigned int e, StepBuffers& buffers);
+  bool anyPerfectMatching(std::vector<unsigned int>& matchEdge);
+  void setMatching(const std::vector<unsigned int>& matchEdge);
+
   unsigned int nodeCount;
-  std::vector<Node> nodes;
-  std::vector<Edge> edges;
+
+  // Potential function of the last run of perfectMatching, the reduced costs
+  // of the residual edges are not negative. Empty after the auction.
+  std::vector<Potential> potentials;
+
+  // Memory of the adjacency lists, has to outlive the nodes
+  Arena graphArena;
+  // State of the dijkstra algorithm, kept over all phases. Between phases,
+  // dist is -1 for every node, a phase only resets the nodes it touched.
+  PageVector<Potential> dist;
+  PageVector<unsigned int> prev;
+  std::vector<unsigned int> touched;
+  // Binary min heap of (distance, node) pairs, may contain outdated entries
+  std::vector<std::pair<Potential, unsigned int>> open;
+  // Buffers for the relaxation candidates of the active node
+  std::vector<unsigned int> candPos;
+  std::vector<Potential> candDist;
+
+  // State of delta stepping, also kept over all phases. buckets[i] holds the
+  // nodes with distances in [i*stepWidth, (i+1)*stepWidth), it may contain
+  // outdated entries. roundDist holds the distances at the start of the
+  // round (-1 between phases), stamp marks the nodes of a round to remove
+  // duplicates.
+  Potential stepWidth = 0;
+  std::vector<std::vector<unsigned int>> buckets;
+  std::vector<unsigned int> frontier;
+  PageVector<Potential> roundDist;
+  std::vector<unsigned int> stamp;
+  unsigned int round = 0;
+  std::vector<StepBuffers> stepBuffers;
+
+  PageVector<Node> nodes;
+
+  // Edge data, indexed by edge id. The active flags are stored as a bitset.
+  // costs has one padding element at the end, so that vector kernels can load
+  // a 32 bit word at the position of the last 16 bit value.
+  PageVector<unsigned int> tails;
+  PageVector<unsigned int> heads;
+  PageVector<Cost> costs;
+  std::vector<bool> activeEdges;
 };
 
+// Graph with the cost types of the original instance format
+typedef BasicGraph<int, long long int> Graph;
+
 #endif
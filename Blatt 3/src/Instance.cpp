@@ -0,0 +1,229 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <thread>
+#include <functional>
+#include "Instance.h"
+
+namespace {
+
+// Files below this size per thread are not split
+const std::size_t minChunkSize = 1 << 20;
+
+// The edges of one chunk of an instance file
+struct EdgeChunk {
+  std::vector<unsigned int> tails;
+  std::vector<unsigned int> heads;
+  std::vector<long long int> costs;
+  // false if parsing stopped before the end of the chunk
+  bool complete = false;
+  // false if an edge is not between the two partitions
+  bool valid = true;
+};
+
+// Skips whitespace and reads a (possibly negative) number at p, returns false
+// if there is none
+bool readNumber(const char*& p, const char* end, long long int& value) {
+  while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+    p++;
+  }
+  bool negative = p < end && *p == '-';
+  if (negative) {
+    p++;
+  }
+  if (p == end || *p < '0' || *p > '9') {
+    return false;
+  }
+  value = 0;
+  while (p < end && *p >= '0' && *p <= '9') {
+    value = value*10 + (*p - '0');
+    p++;
+  }
+  if (negative) {
+    value = -value;
+  }
+  return true;
+}
+
+// Parses the edge lines between begin and end
+void parseChunk(const char* begin, const char* end, unsigned int nodeCount, EdgeChunk& chunk) {
+  long long int a, b, cost;
+  long long int half = nodeCount/2;
+  while (readNumber(begin, end, a) && readNumber(begin, end, b) && readNumber(begin, end, cost)) {
+    if (a < 0 || a >= half || b < half || b >= nodeCount) {
+      chunk.valid = false;
+      return;
+    }
+    chunk.tails.push_back(a);
+    chunk.heads.push_back(b);
+    chunk.costs.push_back(cost);
+  }
+  chunk.complete = begin == end;
+}
+
+// Copies the edges of a chunk to their position in the instance arrays
+void copyChunk(const EdgeChunk& chunk, unsigned int* tails, unsigned int* heads, long long int* costs) {
+  std::copy(chunk.tails.begin(), chunk.tails.end(), tails);
+  std::copy(chunk.heads.begin(), chunk.heads.end(), heads);
+  std::copy(chunk.costs.begin(), chunk.costs.end(), costs);
+}
+
+}
+
+// Parses an instance file. The edge lines are split into up to threadCount
+// chunks at line ends, which are parsed in parallel and concatenated in file
+// order, so edge ids are the same as with sequential parsing. Like a stream,
+// parsing stops at the first malformed edge.
+Instance::Instance(std::string filename, unsigned int threadCount) {
+  std::fstream file(filename, std::ios_base::in | std::ios_base::binary);
+
+  // Check if file is open
+  if (!file.is_open()) {
+    nodeCount = 0;
+    throw(std::runtime_error("File could not be opened."));
+    return;
+  }
+
+  file.seekg(0, std::ios_base::end);
+  std::string text(static_cast<std::size_t>(file.tellg()), '\0');
+  file.seekg(0, std::ios_base::beg);
+  file.read(&text[0], text.size());
+
+  const char* p = text.data();
+  const char* end = p + text.size();
+  long long int n = 0;
+  readNumber(p, end, n);
+  nodeCount = n;
+  if (nodeCount%2 != 0) {
+    throw(std::runtime_error("Tried to load an evenly partitioned bipartite graph with odd node count."));
+    return;
+  }
+
+  // Chunk borders are moved behind the next line end
+  std::size_t size = end - p;
+  unsigned int chunkCount = std::max(1u, std::min(threadCount, static_cast<unsigned int>(size / minChunkSize)));
+  std::vector<const char*> borders(chunkCount + 1, end);
+  borders[0] = p;
+  for (unsigned int i = 1; i < chunkCount; i++) {
+    const char* border = std::max(borders[i-1], p + size / chunkCount * i);
+    border = std::find(border, end, '\n');
+    borders[i] = border == end ? end : border + 1;
+  }
+
+  std::vector<EdgeChunk> chunks(chunkCount);
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < chunkCount; i++) {
+    threads.push_back(std::thread(parseChunk, borders[i], borders[i+1], nodeCount, std::ref(chunks[i])));
+  }
+  parseChunk(borders[0], borders[1], nodeCount, chunks[0]);
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  // Only the chunks up to the first incomplete one are used
+  std::vector<unsigned int> offsets(1, 0);
+  for (unsigned int i = 0; i < chunkCount; i++) {
+    if (!chunks[i].valid) {
+      throw(std::runtime_error("Tried to add an edge between nodes of the wrong partition."));
+    }
+    offsets.push_back(offsets.back() + chunks[i].tails.size());
+    if (!chunks[i].complete) {
+      chunkCount = i + 1;
+      break;
+    }
+  }
+
+  tails.resize(offsets.back());
+  heads.resize(offsets.back());
+  costs.resize(offsets.back());
+  threads.clear();
+  for (unsigned int i = 1; i < chunkCount; i++) {
+    threads.push_back(std::thread(copyChunk, std::cref(chunks[i]), tails.data() + offsets[i], heads.data() + offsets[i],
+      costs.data() + offsets[i]));
+  }
+  copyChunk(chunks[0], tails.data(), heads.data(), costs.data());
+  for (std::thread& t : threads) {
+    t.join();
+  }
+}
+
+// Gets the node count of the instance
+unsigned int Instance::getNodeCount() {
+  return nodeCount;
+}
+
+// Gets the edge count of the instance
+unsigned int Instance::getEdgeCount() {
+  return tails.size();
+}
+
+// Gets the node of the left partition of an edge
+unsigned int Instance::getTail(unsigned int e) {
+  return tails[e];
+}
+
+// Gets the node of the right partition of an edge
+unsigned int Instance::getHead(unsigned int e) {
+  return heads[e];
+}
+
+// Gets the cost of an edge
+long long int Instance::getCost(unsigned int e) {
+  return costs[e];
+}
+
+// Gets the largest absolute value of an edge cost
+unsigned long long int Instance::getMaxAbsCost() {
+  unsigned long long int res = 0;
+  for (long long int c : costs) {
+    unsigned long long int abs = c < 0 ? 0ULL - static_cast<unsigned long long int>(c) : c;
+    if (abs > res) {
+      res = abs;
+    }
+  }
+  return res;
+}
+
+// Keeps only the cheapest of every set of parallel edges (the first one if
+// there are several), a minimum cost matching never uses the others. The
+// remaining edges keep their order.
+void Instance::removeParallelEdges() {
+  std::vector<unsigned int> order(tails.size());
+  for (unsigned int e = 0; e < order.size(); e++) {
+    order[e] = e;
+  }
+  std::sort(order.begin(), order.end(), [this](unsigned int e, unsigned int f) {
+    if (tails[e] != tails[f]) {
+      return tails[e] < tails[f];
+    }
+    if (heads[e] != heads[f]) {
+      return heads[e] < heads[f];
+    }
+    if (costs[e] != costs[f]) {
+      return costs[e] < costs[f];
+    }
+    return e < f;
+  });
+
+  std::vector<bool> keep(tails.size(), false);
+  for (unsigned int i = 0; i < order.size(); i++) {
+    if (i == 0 || tails[order[i]] != tails[order[i-1]] || heads[order[i]] != heads[order[i-1]]) {
+      keep[order[i]] = true;
+    }
+  }
+
+  unsigned int count = 0;
+  for (unsigned int e = 0; e < tails.size(); e++) {
+    if (keep[e]) {
+      tails[count] = tails[e];
+      heads[count] = heads[e];
+      costs[count] = costs[e];
+      count++;
+    }
+  }
+  tails.resize(count);
+  heads.resize(count);
+  costs.resize(count);
+}
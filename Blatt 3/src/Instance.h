@@ -0,0 +1,26 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include <vector>
+#include <string>
+
+// The edges of an evenly partitioned bipartite graph as read from an instance
+// file. The graph is built from it once the needed cost types are known.
+class Instance {
+public:
+  Instance(std::string filename, unsigned int threadCount = 1);
+  unsigned int getNodeCount();
+  unsigned int getEdgeCount();
+  unsigned int getTail(unsigned int e);
+  unsigned int getHead(unsigned int e);
+  long long int getCost(unsigned int e);
+  unsigned long long int getMaxAbsCost();
+  void removeParallelEdges();
+private:
+  unsigned int nodeCount;
+  std::vector<unsigned int> tails;
+  std::vector<unsigned int> heads;
+  std::vector<long long int> costs;
+};
+
+#endif
@@ -0,0 +1,171 @@
+#include "Simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+// Scalar version of relaxCandidates
+template <typename Cost, typename Potential>
+static unsigned int relaxCandidatesScalar(const unsigned int* edges, unsigned int count, const unsigned int* ends,
+  const Cost* costs, const Potential* potential, const Potential* dist, Potential base, int sign,
+  unsigned int* pos, Potential* cand, unsigned int offset) {
+  unsigned int found = 0;
+  for (unsigned int i = 0; i < count; i++) {
+    unsigned int e = edges[i];
+    Potential d = base + sign*static_cast<Potential>(costs[e]) - potential[ends[e]];
+    if (d < dist[ends[e]] || dist[ends[e]] == -1) {
+      pos[found] = offset + i;
+      cand[found] = d;
+      found++;
+    }
+  }
+  return found;
+}
+
+#ifdef SIMD_AVX2
+
+// Gathers the costs of 8 edges as 32 bit values
+__attribute__((target("avx2")))
+static inline __m256i gatherCosts(const int* costs, __m256i idx) {
+  return _mm256_i32gather_epi32(costs, idx, 4);
+}
+
+// 16 bit version, loads the 32 bit words at the positions of the costs and
+// sign extends the lower halves (this needs the padding element)
+__attribute__((target("avx2")))
+static inline __m256i gatherCosts(const short int* costs, __m256i idx) {
+  __m256i words = _mm256_i32gather_epi32(reinterpret_cast<const int*>(costs), idx, 2);
+  return _mm256_srai_epi32(_mm256_slli_epi32(words, 16), 16);
+}
+
+// Gathers the costs of 4 edges as 64 bit values
+__attribute__((target("avx2")))
+static inline __m256i gatherCosts(const long long int* costs, __m128i idx) {
+  return _mm256_i32gather_epi64(costs, idx, 8);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i gatherCosts(const int* costs, __m128i idx) {
+  return _mm256_cvtepi32_epi64(_mm_i32gather_epi32(costs, idx, 4));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i gatherCosts(const short int* costs, __m128i idx) {
+  __m128i words = _mm_i32gather_epi32(reinterpret_cast<const int*>(costs), idx, 2);
+  return _mm256_cvtepi32_epi64(_mm_srai_epi32(_mm_slli_epi32(words, 16), 16));
+}
+
+// AVX2 version of relaxCandidates for 32 bit potentials, 8 edges per iteration
+template <typename Cost>
+__attribute__((target("avx2")))
+static unsigned int relaxCandidatesAvx2(const unsigned int* edges, unsigned int count, const unsigned int* ends,
+  const Cost* costs, const int* potential, const int* dist, int base, int sign,
+  unsigned int* pos, int* cand) {
+  __m256i basev = _mm256_set1_epi32(base);
+  __m256i unreached = _mm256_set1_epi32(-1);
+  unsigned int found = 0;
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(edges + i));
+    __m256i end = _mm256_i32gather_epi32(reinterpret_cast<const int*>(ends), idx, 4);
+    __m256i cost = gatherCosts(costs, idx);
+    __m256i pot = _mm256_i32gather_epi32(potential, end, 4);
+    __m256i old = _mm256_i32gather_epi32(dist, end, 4);
+
+    __m256i d = sign > 0 ? _mm256_add_epi32(basev, cost) : _mm256_sub_epi32(basev, cost);
+    d = _mm256_sub_epi32(d, pot);
+    __m256i better = _mm256_or_si256(_mm256_cmpgt_epi32(old, d), _mm256_cmpeq_epi32(old, unreached));
+
+    unsigned int bits = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(better)));
+    if (bits != 0) {
+      int values[8];
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(values), d);
+      while (bits != 0) {
+        unsigned int lane = __builtin_ctz(bits);
+        pos[found] = i + lane;
+        cand[found] = values[lane];
+        found++;
+        bits &= bits - 1;
+      }
+    }
+  }
+
+  return found + relaxCandidatesScalar(edges + i, count - i, ends, costs, potential, dist, base, sign,
+    pos + found, cand + found, i);
+}
+
+// AVX2 version of relaxCandidates for 64 bit potentials, 4 edges per iteration
+template <typename Cost>
+__attribute__((target("avx2")))
+static unsigned int relaxCandidatesAvx2(const unsigned int* edges, unsigned int count, const unsigned int* ends,
+  const Cost* costs, const long long int* potential, const long long int* dist, long long int base, int sign,
+  unsigned int* pos, long long int* cand) {
+  __m256i basev = _mm256_set1_epi64x(base);
+  __m256i unreached = _mm256_set1_epi64x(-1);
+  unsigned int found = 0;
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(edges + i));
+    __m128i end = _mm_i32gather_epi32(reinterpret_cast<const int*>(ends), idx, 4);
+    __m256i cost = gatherCosts(costs, idx);
+    __m256i pot = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(potential), end, 8);
+    __m256i old = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(dist), end, 8);
+
+    __m256i d = sign > 0 ? _mm256_add_epi64(basev, cost) : _mm256_sub_epi64(basev, cost);
+    d = _mm256_sub_epi64(d, pot);
+    __m256i better = _mm256_or_si256(_mm256_cmpgt_epi64(old, d), _mm256_cmpeq_epi64(old, unreached));
+
+    unsigned int bits = static_cast<unsigned int>(_mm256_movemask_pd(_mm256_castsi256_pd(better)));
+    if (bits != 0) {
+      long long int values[4];
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(values), d);
+      while (bits != 0) {
+        unsigned int lane = __builtin_ctz(bits);
+        pos[found] = i + lane;
+        cand[found] = values[lane];
+        found++;
+        bits &= bits - 1;
+      }
+    }
+  }
+
+  return found + relaxCandidatesScalar(edges + i, count - i, ends, costs, potential, dist, base, sign,
+    pos + found, cand + found, i);
+}
+
+bool simdEnabled() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+
+#else
+
+bool simdEnabled() {
+  return false;
+}
+
+#endif
+
+template <typename Cost, typename Potential>
+unsigned int relaxCandidates(const unsigned int* edges, unsigned int count, const unsigned int* ends,
+  const Cost* costs, const Potential* potential, const Potential* dist, Potential base, int sign,
+  unsigned int* pos, Potential* cand) {
+#ifdef SIMD_AVX2
+  if (simdEnabled()) {
+    return relaxCandidatesAvx2(edges, count, ends, costs, potential, dist, base, sign, pos, cand);
+  }
+#endif
+  return relaxCandidatesScalar(edges, count, ends, costs, potential, dist, base, sign, pos, cand, 0);
+}
+
+template unsigned int relaxCandidates<short int, int>(const unsigned int*, unsigned int, const unsigned int*,
+  const short int*, const int*, const int*, int, int, unsigned int*, int*);
+template unsigned int relaxCandidates<short int, long long int>(const unsigned int*, unsigned int, const unsigned int*,
+  const short int*, const long long int*, const long long int*, long long int, int, unsigned int*, long long int*);
+template unsigned int relaxCandidates<int, int>(const unsigned int*, unsigned int, const unsigned int*,
+  const int*, const int*, const int*, int, int, unsigned int*, int*);
+template unsigned int relaxCandidates<int, long long int>(const unsigned int*, unsigned int, const unsigned int*,
+  const int*, const long long int*, const long long int*, long long int, int, unsigned int*, long long int*);
+template unsigned int relaxCandidates<long long int, long long int>(const unsigned int*, unsigned int, const unsigned int*,
+  const long long int*, const long long int*, const long long int*, long long int, int, unsigned int*, long long int*);
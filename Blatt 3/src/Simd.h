@@ -0,0 +1,22 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// Vectorized relaxation scan for the dijkstra algorithm. The function uses
+// AVX2 if the cpu supports it (checked at runtime) and a scalar loop
+// otherwise. Both variants return exactly the same results.
+
+// Returns true if the AVX2 kernel is used
+bool simdEnabled();
+
+// Computes the tentative distances base + sign*costs[e] - potential[ends[e]]
+// for all edges e of the list, where ends[e] is the node on the other side of
+// the edge. Writes the list positions and distances of all edges which improve
+// the distance of their end node (or reach it for the first time, dist == -1)
+// to pos and cand and returns their number. pos and cand need space for count
+// entries. The cost array needs one padding element after the last edge.
+template <typename Cost, typename Potential>
+unsigned int relaxCandidates(const unsigned int* edges, unsigned int count, const unsigned int* ends,
+  const Cost* costs, const Potential* potential, const Potential* dist, Potential base, int sign,
+  unsigned int* pos, Potential* cand);
+
+#endif
@@ -8,21 +8,180 @@
 #include <vector>
 #include <list>
 #include <fstream>
+#include <limits>
+#include <thread>
+#include <stdexcept>
 #include "Graph.h"
+#include "Instance.h"
+#include "Trace.h"
+#include "PageMemory.h"
+
+// Command line options
+struct Options {
+  std::string outputfile = "";
+  bool outputfileSpecified = false;
+  bool binary = false;
+  bool preprocess = false;
+  bool deltaStepping = false;
+  PageKind pages = TRANSPARENT_HUGE_PAGES;
+  // anytime auction, stops after timeLimit seconds (if positive) or when the
+  // matching is within n/2 * epsilon of the optimum
+  bool auction = false;
+  double timeLimit = 0;
+  double epsilon = 0;
+  bool verify = false;
+  unsigned int threadCount = std::thread::hardware_concurrency();
+};
+
+// Solves the instance with the graph type G and writes the matching
+template <typename G>
+void solve(Instance& instance, Options& o) {
+  Trace::Scope building("build graph");
+  G g(instance);
+  building.end();
+
+  if (o.auction) {
+    // The gap to the optimum is reported separately from the matching
+    long long int lowerBound = g.auction(o.timeLimit, o.epsilon);
+    std::vector<unsigned int> matching;
+    long long int value = g.getMatching(matching);
+    std::cerr << "Lower bound: " << lowerBound << ", gap at most " << value - lowerBound << '\n';
+  } else {
+    g.perfectMatching(o.deltaStepping, o.threadCount);
+  }
+
+  if (o.verify) {
+    Trace::Scope verifying("verify");
+    std::string error;
+    if (g.verifyMatching(error)) {
+      std::cerr << "Verification passed." << '\n';
+    } else {
+      std::cerr << "Verification failed: " << error << "." << '\n';
+    }
+  }
+
+  Trace::Scope writing("write output");
+  if (!o.outputfileSpecified) {
+    if (o.binary) {
+      g.exportMatchingBinary(std::cout);
+    } else {
+      g.exportMatching(std::cout);
+    }
+  } else if (o.binary) {
+    std::fstream file(o.outputfile, std::ios_base::out | std::ios_base::binary);
+    g.exportMatchingBinary(file);
+  } else {
+    std::fstream file(o.outputfile, std::ios_base::out);
+    g.exportMatching(file);
+  }
+}
+
+// Solves the instance with the cost type Cost and the narrowest potential type
+// that can hold the distances of the instance
+template <typename Cost>
+void solve(Instance& instance, Options& o, bool smallPotential) {
+  if (smallPotential) {
+    solve<BasicGraph<Cost, int>>(instance, o);
+  } else {
+    solve<BasicGraph<Cost, long long int>>(instance, o);
+  }
+}
 
 // Main function
 int main(int argc, char** argv) {
-  std::string outputfile = "";
+  Options o;
   std::string filename = "";
   bool filenameSpecified = false;
-  bool outputfileSpecified = false;
   for (int i=1; i<argc; i++) {
     if (argv[i][0] == '-') {
-      // Output file can be specified
-      if (argv[i][1] == 'o') {
+      std::string option(argv[i]);
+      if (option == "--time-limit") {
+        // Time limit of the auction in seconds
         if (i+1 < argc) {
-          outputfile = std::string(argv[i+1]);
-          outputfileSpecified = true;
+          try {
+            o.timeLimit = std::stod(argv[i+1]);
+          } catch (std::logic_error&) {
+            std::cout << "Invalid time limit " << argv[i+1] << "." << '\n';
+            return 0;
+          }
+          o.auction = true;
+          i++;
+        }
+      } else if (option == "--verify") {
+        // Check the matching (and its optimality) after the computation
+        o.verify = true;
+      } else if (option == "--pages") {
+        // Pages of the large arrays: small, thp or huge
+        if (i+1 < argc) {
+          std::string name(argv[i+1]);
+          if (name == "small") {
+            o.pages = SMALL_PAGES;
+          } else if (name == "thp") {
+            o.pages = TRANSPARENT_HUGE_PAGES;
+          } else if (name == "huge") {
+            o.pages = EXPLICIT_HUGE_PAGES;
+          } else {
+            std::cout << "Unknown page kind " << name << "." << '\n';
+            return 0;
+          }
+          i++;
+        }
+      } else if (option == "--trace") {
+        // Write a timeline of the phases at exit
+        if (i+1 < argc) {
+          Trace::enable(argv[i+1]);
+          i++;
+        }
+      } else if (option == "--epsilon") {
+        // Allowed gap per node of the auction
+        if (i+1 < argc) {
+          try {
+            o.epsilon = std::stod(argv[i+1]);
+          } catch (std::logic_error&) {
+            std::cout << "Invalid epsilon " << argv[i+1] << "." << '\n';
+            return 0;
+          }
+          o.auction = true;
+          i++;
+        }
+      } else if (argv[i][1] == 'o') {
+        // Output file can be specified
+        if (i+1 < argc) {
+          o.outputfile = std::string(argv[i+1]);
+          o.outputfileSpecified = true;
+          i++;
+        }
+      } else if (argv[i][1] == 'b') {
+        // Write the matching in binary format
+        o.binary = true;
+      } else if (argv[i][1] == 'p') {
+        // Remove parallel edges before computing the matching
+        o.preprocess = true;
+      } else if (argv[i][1] == 'a') {
+        // Algorithm: dijkstra, delta (delta stepping) or auction
+        if (i+1 < argc) {
+          std::string name(argv[i+1]);
+          if (name == "delta") {
+            o.deltaStepping = true;
+          } else if (name == "dijkstra") {
+            o.deltaStepping = false;
+          } else if (name == "auction") {
+            o.auction = true;
+          } else {
+            std::cout << "Unknown algorithm " << name << "." << '\n';
+            return 0;
+          }
+          i++;
+        }
+      } else if (argv[i][1] == 'j') {
+        // Number of threads for parsing and delta stepping
+        if (i+1 < argc) {
+          try {
+            o.threadCount = std::stoul(argv[i+1]);
+          } catch (std::logic_error&) {
+            std::cout << "Invalid thread count " << argv[i+1] << "." << '\n';
+            return 0;
+          }
           i++;
         }
       }
@@ -37,16 +196,31 @@ int main(int argc, char** argv) {
     return 0;
   }
 
+  // Only delta stepping runs in parallel
+  PageMemory::configure(o.pages, o.deltaStepping ? o.threadCount : 1);
+  Trace::Scope loading("load instance");
+  Instance instance(filename, o.threadCount);
+  loading.end();
+  if (o.preprocess) {
+    Trace::Scope reducing("remove parallel edges");
+    instance.removeParallelEdges();
+  }
 
-  Graph g(filename);
-
-  g.perfectMatching();
-
-  if (!outputfileSpecified) {
-    g.exportMatching(std::cout);
+  // Use the narrowest cost types the instance fits into. Potentials are
+  // bounded by the length of a path through all nodes, 32 bit potentials are
+  // used if that bound fits with a margin of 16 for the intermediate sums.
+  unsigned long long int maxCost = instance.getMaxAbsCost();
+  unsigned long long int nodes = instance.getNodeCount() + 2;
+  bool smallPotential = maxCost == 0 ||
+    nodes <= static_cast<unsigned long long int>(std::numeric_limits<int>::max())/16/maxCost;
+  if (maxCost <= static_cast<unsigned long long int>(std::numeric_limits<short int>::max())) {
+    solve<short int>(instance, o, smallPotential);
+  } else if (maxCost <= static_cast<unsigned long long int>(std::numeric_limits<int>::max())) {
+    solve<int>(instance, o, smallPotential);
   } else {
-    std::fstream file(outputfile, std::ios_base::out);
-    g.exportMatching(file);
+    // 64 bit costs always need 64 bit potentials
+    solve<BasicGraph<long long int, long long int>>(instance, o);
   }
+
   return 0;
 }
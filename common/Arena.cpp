@@ -0,0 +1,90 @@
+#include <cstddef>
+#include <new>
+#include <algorithm>
+#include "Arena.h"
+#include "PageMemory.h"
+
+// std::min takes its arguments by reference, so the constant needs a
+// definition
+const std::size_t Arena::maxBlockSize;
+
+// Constructor, blocks are allocated lazily
+Arena::Arena(std::size_t blockSize) {
+  this->blockSize = blockSize;
+}
+
+Arena::~Arena() {
+  for (Block& b : blocks) {
+    PageMemory::deallocate(b.data, b.size);
+  }
+}
+
+// Gets a chunk of at least the given size
+void* Arena::allocate(std::size_t bytes) {
+  bytes = (bytes + alignment - 1) / alignment * alignment;
+  if (bytes == 0) {
+    bytes = alignment;
+  }
+
+  // Reuse a freed chunk of the same size if possible
+  std::size_t sizeClass = bytes/alignment - 1;
+  if (sizeClass < sizeClasses && freeLists[sizeClass] != nullptr) {
+    FreeChunk* chunk = freeLists[sizeClass];
+    freeLists[sizeClass] = chunk->next;
+    return chunk;
+  }
+
+  // Go to the next block which is large enough if the current one is full
+  while (current < blocks.size() && offset + bytes > blocks[current].size) {
+    current++;
+    offset = 0;
+  }
+
+  // New blocks are as large as all blocks before (up to maxBlockSize), so
+  // that large arenas consist of few blocks which can use huge pages
+  if (current == blocks.size()) {
+    Block b;
+    b.size = std::max(std::max(bytes, blockSize), std::min(getCapacity(), maxBlockSize));
+    b.data = static_cast<char*>(PageMemory::allocate(b.size));
+    blocks.push_back(b);
+    offset = 0;
+  }
+
+  void* res = blocks[current].data + offset;
+  offset += bytes;
+  return res;
+}
+
+// Gives back a chunk, only small chunks are recycled before the next reset
+void Arena::deallocate(void* p, std::size_t bytes) {
+  bytes = (bytes + alignment - 1) / alignment * alignment;
+  if (bytes == 0) {
+    bytes = alignment;
+  }
+
+  std::size_t sizeClass = bytes/alignment - 1;
+  if (sizeClass < sizeClasses) {
+    FreeChunk* chunk = static_cast<FreeChunk*>(p);
+    chunk->next = freeLists[sizeClass];
+    freeLists[sizeClass] = chunk;
+  }
+}
+
+// Frees all chunks at once, the blocks are kept for later allocations
+// All containers using the arena have to be destroyed before
+void Arena::reset() {
+  current = 0;
+  offset = 0;
+  for (std::size_t i = 0; i < sizeClasses; i++) {
+    freeLists[i] = nullptr;
+  }
+}
+
+// Gets the number of bytes reserved by the arena
+std::size_t Arena::getCapacity() {
+  std::size_t res = 0;
+  for (Block& b : blocks) {
+    res += b.size;
+  }
+  return res;
+}
@@ -0,0 +1,83 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <vector>
+#include <list>
+
+// Monotonic memory arena. Memory is handed out from large blocks and is only
+// given back as a whole by reset(), which keeps the blocks for the next run.
+// Small freed chunks are recycled through free lists, so containers with a lot
+// of churn (e.g. lists) do not make the arena grow without bounds.
+class Arena {
+public:
+  Arena(std::size_t blockSize = 1 << 16);
+  ~Arena();
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+  void* allocate(std::size_t bytes);
+  void deallocate(void* p, std::size_t bytes);
+  void reset();
+  std::size_t getCapacity();
+private:
+  // alignment of all chunks and granularity of the free lists
+  static const std::size_t alignment = 16;
+  static const std::size_t sizeClasses = 16;
+  static const std::size_t maxBlockSize = 1 << 26;
+
+  struct Block {
+    char* data;
+    std::size_t size;
+  };
+
+  struct FreeChunk {
+    FreeChunk* next;
+  };
+
+  std::size_t blockSize;
+  std::vector<Block> blocks;
+  std::size_t current = 0;
+  std::size_t offset = 0;
+  FreeChunk* freeLists[sizeClasses] = {};
+};
+
+// Standard allocator drawing its memory from an arena
+template <typename T>
+class ArenaAllocator {
+public:
+  typedef T value_type;
+
+  ArenaAllocator(Arena& arena) : arena(&arena) { }
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& o) : arena(o.getArena()) { }
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(arena->allocate(n*sizeof(T)));
+  }
+  void deallocate(T* p, std::size_t n) {
+    arena->deallocate(p, n*sizeof(T));
+  }
+  Arena* getArena() const {
+    return arena;
+  }
+private:
+  Arena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.getArena() == b.getArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.getArena() != b.getArena();
+}
+
+// Containers using an arena
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+template <typename T>
+using ArenaList = std::list<T, ArenaAllocator<T>>;
+
+#endif
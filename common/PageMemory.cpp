@@ -0,0 +1,153 @@
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "PageMemory.h"
+
+PageKind PageMemory::kind = TRANSPARENT_HUGE_PAGES;
+unsigned int PageMemory::threadCount = 1;
+unsigned long int PageMemory::nodeMask = 0;
+
+namespace {
+
+const std::size_t hugePageSize = 1 << 21;
+// Arrays which are first touched by all threads
+const std::size_t touchSize = 1 << 24;
+// MPOL_INTERLEAVE of linux/mempolicy.h
+const int interleavePolicy = 3;
+
+// Rounds the size up to whole huge pages
+std::size_t roundUp(std::size_t bytes) {
+  return (bytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+}
+
+// Reads the online NUMA nodes ("0-1,3") into a mask, 0 for a single node
+unsigned long int readNodeMask() {
+  std::ifstream file("/sys/devices/system/node/online");
+  std::string text;
+  if (!(file >> text)) {
+    return 0;
+  }
+  unsigned long int mask = 0;
+  unsigned int count = 0;
+  std::size_t pos = 0;
+  while (pos < text.size()) {
+    std::size_t end = text.find(',', pos);
+    std::string range = text.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+    std::size_t dash = range.find('-');
+    unsigned long int first = std::strtoul(range.c_str(), nullptr, 10);
+    unsigned long int last = dash == std::string::npos ? first : std::strtoul(range.c_str() + dash + 1, nullptr, 10);
+    for (unsigned long int i = first; i <= last && i < 8 * sizeof(mask); i++) {
+      mask |= 1UL << i;
+      count++;
+    }
+    pos = end == std::string::npos ? text.size() : end + 1;
+  }
+  return count > 1 ? mask : 0;
+}
+
+// Writes to every page of [begin, end)
+void touchPages(char* begin, char* end) {
+  for (char* p = begin; p < end; p += 4096) {
+    *p = 0;
+  }
+}
+
+}
+
+// Sets the page kind and the number of threads of the run
+void PageMemory::configure(PageKind kind, unsigned int threadCount) {
+  PageMemory::kind = kind;
+  PageMemory::threadCount = std::max(1u, threadCount);
+  nodeMask = readNodeMask();
+}
+
+// Gets memory for an array of the given size
+void* PageMemory::allocate(std::size_t bytes) {
+  if (bytes < largeSize) {
+    void* p = std::malloc(bytes == 0 ? 1 : bytes);
+    if (p == nullptr) {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+  char* data = static_cast<char*>(map(bytes));
+  place(data, roundUp(bytes));
+  return data;
+}
+
+// Gives back the memory of an array
+void PageMemory::deallocate(void* p, std::size_t bytes) {
+  if (bytes < largeSize) {
+    std::free(p);
+  } else {
+    munmap(p, roundUp(bytes));
+  }
+}
+
+// Maps whole huge pages for the array
+void* PageMemory::map(std::size_t bytes) {
+  std::size_t size = roundUp(bytes);
+#ifdef MAP_HUGETLB
+  if (kind == EXPLICIT_HUGE_PAGES) {
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+      return p;
+    }
+  }
+#endif
+
+  // The mapping is aligned to 2 MiB by cutting off its ends, otherwise the
+  // kernel can not back the first and last part with huge pages
+  char* raw = static_cast<char*>(mmap(nullptr, size + hugePageSize, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (raw == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  std::size_t skip = (hugePageSize - reinterpret_cast<std::size_t>(raw) % hugePageSize) % hugePageSize;
+  if (skip > 0) {
+    munmap(raw, skip);
+  }
+  if (hugePageSize - skip > 0) {
+    munmap(raw + skip + size, hugePageSize - skip);
+  }
+  char* data = raw + skip;
+
+#ifdef MADV_HUGEPAGE
+  if (kind != SMALL_PAGES) {
+    madvise(data, size, MADV_HUGEPAGE);
+  }
+#endif
+  return data;
+}
+
+// Places the pages of a new mapping for a parallel run: interleaved over the
+// NUMA nodes, and faulted in by all threads
+void PageMemory::place(char* data, std::size_t bytes) {
+  if (threadCount == 1) {
+    return;
+  }
+#ifdef SYS_mbind
+  if (nodeMask != 0) {
+    syscall(SYS_mbind, data, bytes, interleavePolicy, &nodeMask, 8 * sizeof(nodeMask) + 1, 0);
+  }
+#endif
+  if (bytes >= touchSize) {
+    std::size_t part = (bytes / threadCount + 4095) / 4096 * 4096;
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < threadCount && i * part < bytes; i++) {
+      threads.push_back(std::thread(touchPages, data + i * part, data + std::min(bytes, (i + 1) * part)));
+    }
+    touchPages(data, data + std::min(bytes, part));
+    for (std::thread& t : threads) {
+      t.join();
+    }
+  }
+}
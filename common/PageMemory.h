@@ -0,0 +1,74 @@
+#ifndef PAGEMEMORY_H
+#define PAGEMEMORY_H
+
+#include <cstddef>
+#include <vector>
+
+// Kinds of pages for large arrays
+enum PageKind {
+  // ordinary pages
+  SMALL_PAGES,
+  // transparent huge pages, requested with madvise
+  TRANSPARENT_HUGE_PAGES,
+  // explicit 2 MiB pages (MAP_HUGETLB), transparent huge pages if the system
+  // has none reserved
+  EXPLICIT_HUGE_PAGES
+};
+
+// Memory of the large arrays of the graphs (edge arrays, arena blocks).
+// Arrays of at least largeSize bytes are mapped on their own, aligned to
+// 2 MiB, with pages of the configured kind. In parallel runs (more than one
+// thread) they are interleaved over the NUMA nodes and first touched by all
+// threads, so that no single node holds a whole array. Features which are not
+// available (huge pages, mbind, several nodes) are skipped. Smaller arrays
+// come from malloc.
+class PageMemory {
+public:
+  static const std::size_t largeSize = 1 << 20;
+
+  static void configure(PageKind kind, unsigned int threadCount);
+  static void* allocate(std::size_t bytes);
+  static void deallocate(void* p, std::size_t bytes);
+private:
+  static void* map(std::size_t bytes);
+  static void place(char* data, std::size_t bytes);
+
+  static PageKind kind;
+  static unsigned int threadCount;
+  // mask of the online NUMA nodes, 0 if there is at most one
+  static unsigned long int nodeMask;
+};
+
+// Standard allocator drawing its memory from PageMemory
+template <typename T>
+class PageAllocator {
+public:
+  typedef T value_type;
+
+  PageAllocator() { }
+  template <typename U>
+  PageAllocator(const PageAllocator<U>&) { }
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(PageMemory::allocate(n*sizeof(T)));
+  }
+  void deallocate(T* p, std::size_t n) {
+    PageMemory::deallocate(p, n*sizeof(T));
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const PageAllocator<T>&, const PageAllocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const PageAllocator<T>&, const PageAllocator<U>&) {
+  return false;
+}
+
+// Vector using PageMemory
+template <typename T>
+using PageVector = std::vector<T, PageAllocator<T>>;
+
+#endif
@@ -0,0 +1,132 @@
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <cstdlib>
+#include <unistd.h>
+#include "Trace.h"
+#include "Writer.h"
+
+bool Trace::enabled = false;
+std::string Trace::filename = "";
+
+namespace {
+
+struct Event {
+  const char* name;
+  unsigned long long int start;
+  unsigned long long int end;
+};
+
+// Events of one thread, the buffers are owned by the list of all buffers, so
+// they outlive their threads
+struct Buffer {
+  unsigned int thread;
+  std::vector<Event> events;
+};
+
+std::mutex buffersMutex;
+std::vector<std::unique_ptr<Buffer>> buffers;
+thread_local Buffer* threadBuffer = nullptr;
+
+// Buffer of the calling thread, created on its first event
+Buffer& getBuffer() {
+  if (threadBuffer == nullptr) {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffers.push_back(std::unique_ptr<Buffer>(new Buffer()));
+    threadBuffer = buffers.back().get();
+    threadBuffer->thread = buffers.size() - 1;
+    threadBuffer->events.reserve(4096);
+  }
+  return *threadBuffer;
+}
+
+// Writes a time in nanoseconds with the unit unit (in nanoseconds) and the
+// given number of decimals
+void writeTime(Writer& w, unsigned long long int t, unsigned long long int unit, int decimals) {
+  w.writeUInt(t / unit);
+  w.writeChar('.');
+  unsigned long long int fraction = t % unit;
+  for (int i = 0; i < decimals; i++) {
+    unit /= 10;
+    w.writeChar(static_cast<char>('0' + fraction / unit));
+    fraction %= unit;
+  }
+}
+
+}
+
+// Starts recording
+void Trace::enable(const std::string& filename) {
+  if (!enabled) {
+    std::atexit(&Trace::write);
+  }
+  Trace::filename = filename;
+  enabled = true;
+}
+
+// Current time in nanoseconds
+unsigned long long int Trace::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Records an event of the calling thread
+void Trace::record(const char* name, unsigned long long int start, unsigned long long int end) {
+  getBuffer().events.push_back(Event{name, start, end});
+}
+
+// Writes the trace and the markers, called at exit
+void Trace::write() {
+  std::lock_guard<std::mutex> lock(buffersMutex);
+  unsigned long long int pid = getpid();
+
+  std::fstream file(filename, std::ios_base::out);
+  Writer w(file);
+  const char* separator = "";
+  w.writeString("{\"traceEvents\":[\n");
+  for (std::unique_ptr<Buffer>& buffer : buffers) {
+    w.writeString(separator);
+    w.writeString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":");
+    w.writeUInt(pid);
+    w.writeString(",\"tid\":");
+    w.writeUInt(buffer->thread);
+    w.writeString(",\"args\":{\"name\":\"thread ");
+    w.writeUInt(buffer->thread);
+    w.writeString("\"}}");
+    separator = ",\n";
+
+    for (Event& event : buffer->events) {
+      w.writeString(separator);
+      w.writeString("{\"name\":\"");
+      w.writeString(event.name);
+      w.writeString("\",\"ph\":\"X\",\"ts\":");
+      writeTime(w, event.start, 1000, 3);
+      w.writeString(",\"dur\":");
+      writeTime(w, event.end - event.start, 1000, 3);
+      w.writeString(",\"pid\":");
+      w.writeUInt(pid);
+      w.writeString(",\"tid\":");
+      w.writeUInt(buffer->thread);
+      w.writeChar('}');
+    }
+  }
+  w.writeString("\n],\"displayTimeUnit\":\"ms\"}\n");
+  w.flush();
+
+  std::fstream markerFile(filename + ".markers", std::ios_base::out);
+  Writer m(markerFile);
+  for (std::unique_ptr<Buffer>& buffer : buffers) {
+    for (Event& event : buffer->events) {
+      writeTime(m, event.start, 1000000000, 6);
+      m.writeChar(' ');
+      writeTime(m, event.end, 1000000000, 6);
+      m.writeChar(' ');
+      m.writeUInt(buffer->thread);
+      m.writeChar(' ');
+      m.writeString(event.name);
+      m.writeChar('\n');
+    }
+  }
+}
@@ -0,0 +1,82 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+
+// Timeline of the phases of a run. Every thread records its events into an
+// own buffer, nothing is written before the program exits. The timeline is
+// written in the Chrome trace event format (chrome://tracing, Perfetto) and as
+// a list of markers, one "start end thread name" line per event.
+//
+// The timestamps are CLOCK_MONOTONIC (steady_clock), the markers are in
+// seconds like the timestamps of perf script for a recording with
+// perf record -k mono, so the phases can be matched with the samples.
+//
+// Without enable(), recording is a single check of a flag. Event names have
+// to be string literals.
+class Trace {
+public:
+  // Starts recording, the trace is written to filename and the markers to
+  // filename.markers at exit
+  static void enable(const std::string& filename);
+  static bool isEnabled() { return enabled; }
+  static unsigned long long int now();
+  static void record(const char* name, unsigned long long int start, unsigned long long int end);
+
+  // Records an event from construction to destruction
+  class Scope {
+  public:
+    Scope(const char* name) : name(name), start(enabled ? now() : 0) { }
+    ~Scope() {
+      end();
+    }
+    // Records the event before the end of the scope
+    void end() {
+      if (enabled && name != nullptr) {
+        record(name, start, now());
+      }
+      name = nullptr;
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  private:
+    const char* name;
+    unsigned long long int start;
+  };
+
+  // Records one event for every size calls of tick(), for steps which are
+  // too frequent for an event each. flush() records the unfinished burst.
+  class Burst {
+  public:
+    constexpr Burst(const char* name, unsigned int size) : name(name), size(size) { }
+    void tick() {
+      if (enabled) {
+        if (count == 0) {
+          start = now();
+        }
+        if (++count == size) {
+          flush();
+        }
+      }
+    }
+    void flush() {
+      if (count > 0) {
+        record(name, start, now());
+        count = 0;
+      }
+    }
+  private:
+    const char* name;
+    unsigned int size;
+    unsigned int count = 0;
+    unsigned long long int start = 0;
+  };
+
+private:
+  static void write();
+
+  static bool enabled;
+  static std::string filename;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include <cstring>
+#include "Writer.h"
+
+// Constructor, the buffer is allocated once
+Writer::Writer(std::ostream& out, std::size_t bufferSize) : out(out), buffer(bufferSize < 64 ? 64 : bufferSize) { }
+
+Writer::~Writer() {
+  flush();
+}
+
+// Makes sure that count more bytes fit into the buffer
+void Writer::reserve(std::size_t count) {
+  if (used + count > buffer.size()) {
+    flush();
+  }
+}
+
+// Writes a single character
+void Writer::writeChar(char c) {
+  reserve(1);
+  buffer[used++] = c;
+}
+
+// Writes a zero terminated string
+void Writer::writeString(const char* str) {
+  writeBytes(str, std::strlen(str));
+}
+
+// Writes an unsigned integer in decimal format
+void Writer::writeUInt(unsigned long long int a) {
+  // the digits are generated from the back
+  char digits[20];
+  int count = 0;
+  do {
+    digits[count++] = static_cast<char>('0' + a % 10);
+    a /= 10;
+  } while (a != 0);
+
+  reserve(count);
+  while (count > 0) {
+    buffer[used++] = digits[--count];
+  }
+}
+
+// Writes a signed integer in decimal format
+void Writer::writeInt(long long int a) {
+  if (a < 0) {
+    writeChar('-');
+    // negate in unsigned arithmetic, works for the smallest value as well
+    writeUInt(0ULL - static_cast<unsigned long long int>(a));
+  } else {
+    writeUInt(static_cast<unsigned long long int>(a));
+  }
+}
+
+// Writes raw bytes
+void Writer::writeBytes(const char* data, std::size_t count) {
+  if (count > buffer.size()) {
+    flush();
+    out.write(data, count);
+    return;
+  }
+  reserve(count);
+  std::memcpy(buffer.data() + used, data, count);
+  used += count;
+}
+
+// Writes a 32 bit integer in binary format
+void Writer::writeUInt32(std::uint32_t a) {
+  reserve(4);
+  for (int i = 0; i < 4; i++) {
+    buffer[used++] = static_cast<char>((a >> (8*i)) & 0xff);
+  }
+}
+
+// Writes a 64 bit integer in binary format
+void Writer::writeUInt64(std::uint64_t a) {
+  reserve(8);
+  for (int i = 0; i < 8; i++) {
+    buffer[used++] = static_cast<char>((a >> (8*i)) & 0xff);
+  }
+}
+
+// Writes the buffer to the stream
+void Writer::flush() {
+  if (used > 0) {
+    out.write(buffer.data(), used);
+    used = 0;
+  }
+}
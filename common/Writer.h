@@ -0,0 +1,34 @@
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <iostream>
+
+// Buffered output. Integers are formatted into a large buffer which is
+// written to the stream with a single write call when it is full, on flush()
+// and on destruction. Binary values are written in little endian byte order.
+class Writer {
+public:
+  Writer(std::ostream& out, std::size_t bufferSize = 1 << 20);
+  ~Writer();
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+  void writeChar(char c);
+  void writeString(const char* str);
+  void writeUInt(unsigned long long int a);
+  void writeInt(long long int a);
+  void writeBytes(const char* data, std::size_t count);
+  void writeUInt32(std::uint32_t a);
+  void writeUInt64(std::uint64_t a);
+  void flush();
+private:
+  void reserve(std::size_t count);
+
+  std::ostream& out;
+  std::vector<char> buffer;
+  std::size_t used = 0;
+};
+
+#endif
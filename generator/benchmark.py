@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""Scaling benchmark of the three solvers on generated instances.
+
+Builds the solvers and the generator, then solves an instance of every type
+for edge counts 10^min-exp, ..., 10^max-exp. The running time (wall clock)
+and the peak memory (maximum resident set size) of every run are written to
+results.csv in the work directory, together with the gnuplot script
+scaling.gp. If gnuplot is installed, it charts both as scaling.png.
+
+Generating the instance is not part of the measured time. Runs which take
+longer than the timeout are stopped and recorded as "timeout", the larger
+instances of the type are skipped. The peak memory is measured from the fork
+of this script, so it has a floor of the size of the Python process (about
+12 MiB), which dominates the smallest runs.
+
+Usage: benchmark.py [--min-exp 4] [--max-exp 8] [--timeout 600] [--seed 1]
+                    [--types mst-random,flow-grid,...] [--work DIR]
+                    [--mst-args ARGS] [--flow-args ARGS] [--matching-args ARGS]
+
+The solver arguments are passed to the solvers of Blatt 1, 2 and 3, for
+example --flow-args "-a bk" to measure Boykov-Kolmogorov.
+"""
+
+import argparse
+import os
+import shlex
+import shutil
+import subprocess
+import sys
+import threading
+import time
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# solver (Blatt) of every instance type
+TYPES = [
+    ("mst-random", 1), ("mst-grid", 1),
+    ("flow-rmat", 2), ("flow-layered", 2), ("flow-grid", 2),
+    ("matching-dense", 3), ("matching-sparse", 3),
+]
+
+
+def build(work):
+    """Builds the solvers and the generator into work, returns their paths."""
+    binaries = {}
+    blatt1 = os.path.join(work, "blatt1")
+    subprocess.check_call(["g++", "-std=c++11", "-O3", "-pthread", "-I", os.path.join(REPO, "common"),
+                           "-o", blatt1, os.path.join(REPO, "Blatt 1", "aufgabe1.cpp")])
+    binaries[1] = blatt1
+    for name, key in (("Blatt 2", 2), ("Blatt 3", 3), ("generator", "generator")):
+        target = os.path.join(work, name.replace(" ", "").lower())
+        os.makedirs(os.path.join(target, "obj"), exist_ok=True)
+        os.makedirs(os.path.join(target, "bin"), exist_ok=True)
+        subprocess.check_call(["make", "-s", "-C", os.path.join(REPO, name),
+                               "OBJ_DIR=" + os.path.join(target, "obj"),
+                               "BIN_DIR=" + os.path.join(target, "bin")])
+        binaries[key] = os.path.join(target, "bin", "main")
+    return binaries
+
+
+def measure(command, stdin_text, timeout):
+    """Runs command, returns (seconds, peak memory in MiB, status)."""
+    start = time.monotonic()
+    process = subprocess.Popen(command, stdin=subprocess.PIPE,
+                               stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    timer = threading.Timer(timeout, process.kill)
+    timer.start()
+    process.stdin.write(stdin_text.encode())
+    process.stdin.close()
+    # wait4 gives the resource usage of this child alone
+    _, status, usage = os.wait4(process.pid, 0)
+    seconds = time.monotonic() - start
+    timed_out = not timer.is_alive()
+    timer.cancel()
+    if timed_out:
+        state = "timeout"
+    elif status != 0:
+        state = "error"
+    else:
+        state = "ok"
+    return seconds, usage.ru_maxrss / 1024.0, state
+
+
+def write_gnuplot(work, types):
+    """Writes scaling.gp, which charts time and memory over the edge count."""
+    lines = [
+        "set datafile separator ','",
+        "set terminal pngcairo size 1400,600",
+        "set output 'scaling.png'",
+        "set multiplot layout 1,2",
+        "set logscale xy",
+        "set xlabel 'edges'",
+        "set key left top",
+        "set grid",
+    ]
+    for column, label in ((3, "time [s]"), (4, "peak memory [MiB]")):
+        lines.append("set ylabel '%s'" % label)
+        plots = ["'results.csv' using (strcol(1) eq '%s' && strcol(5) eq 'ok' ? $2 : 1/0):%d "
+                 "with linespoints title '%s'" % (t, column, t) for t in types]
+        lines.append("plot " + ", \\\n  ".join(plots))
+    lines.append("unset multiplot")
+    with open(os.path.join(work, "scaling.gp"), "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Scaling benchmark of the solvers")
+    parser.add_argument("--min-exp", type=int, default=4)
+    parser.add_argument("--max-exp", type=int, default=8)
+    parser.add_argument("--timeout", type=float, default=600)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--types", default=",".join(t for t, _ in TYPES))
+    parser.add_argument("--work", default=os.path.join(REPO, "generator", "benchmark"))
+    parser.add_argument("--mst-args", default="")
+    parser.add_argument("--flow-args", default="")
+    parser.add_argument("--matching-args", default="")
+    args = parser.parse_args()
+    solver_args = {1: shlex.split(args.mst_args), 2: shlex.split(args.flow_args),
+                   3: shlex.split(args.matching_args)}
+
+    known = dict(TYPES)
+    types = [t for t in args.types.split(",") if t]
+    for t in types:
+        if t not in known:
+            sys.exit("Unknown instance type %s." % t)
+
+    os.makedirs(args.work, exist_ok=True)
+    binaries = build(args.work)
+    instance = os.path.join(args.work, "instance.txt")
+    output = os.path.join(args.work, "output.txt")
+
+    with open(os.path.join(args.work, "results.csv"), "w") as results:
+        results.write("type,edges,seconds,max_rss_mib,status\n")
+        timed_out = set()
+        for exp in range(args.min_exp, args.max_exp + 1):
+            edges = 10 ** exp
+            for t in types:
+                if t in timed_out:
+                    row = "%s,%d,,,skipped" % (t, edges)
+                    print(row, flush=True)
+                    results.write(row + "\n")
+                    continue
+                subprocess.check_call([binaries["generator"], t, str(edges),
+                                       "-s", str(args.seed), "-o", instance])
+                blatt = known[t]
+                if blatt == 1:
+                    # the output file is asked for on standard input
+                    command = [binaries[1], instance] + solver_args[1]
+                    stdin_text = output + "\n"
+                else:
+                    command = [binaries[blatt], instance, "-o", output] + solver_args[blatt]
+                    stdin_text = ""
+                seconds, memory, state = measure(command, stdin_text, args.timeout)
+                if state == "timeout":
+                    timed_out.add(t)
+                row = "%s,%d,%.3f,%.1f,%s" % (t, edges, seconds, memory, state)
+                print(row, flush=True)
+                results.write(row + "\n")
+                results.flush()
+                os.remove(instance)
+                if os.path.exists(output):
+                    os.remove(output)
+
+    write_gnuplot(args.work, types)
+    if shutil.which("gnuplot"):
+        subprocess.check_call(["gnuplot", "scaling.gp"], cwd=args.work)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,220 @@
+#include <vector>
+#include <random>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include "Generator.h"
+#include "Writer.h"
+
+// Constructor
+Generator::Generator(std::ostream& out, unsigned long long int seed, unsigned long long int maxValue)
+  : random(seed), w(out), maxValue(std::max(1ULL, maxValue)) { }
+
+// Checks that the nodes can be numbered with 32 bit ids
+unsigned int Generator::checkNodeCount(unsigned long long int nodeCount) {
+  if (nodeCount > std::numeric_limits<unsigned int>::max()) {
+    throw(std::runtime_error("Generator: Too many nodes."));
+  }
+  return nodeCount;
+}
+
+// Writes the line with the node count
+void Generator::writeHeader(unsigned int nodeCount) {
+  w.writeUInt(nodeCount);
+  w.writeChar('\n');
+}
+
+// Writes the line of an edge
+void Generator::writeEdge(unsigned int a, unsigned int b, unsigned long long int value) {
+  w.writeUInt(a);
+  w.writeChar(' ');
+  w.writeUInt(b);
+  w.writeChar(' ');
+  w.writeUInt(value);
+  w.writeChar('\n');
+}
+
+// A uniform random node of 0, ..., count-1
+unsigned int Generator::randomNode(unsigned int count) {
+  return std::uniform_int_distribution<unsigned int>(0, count-1)(random);
+}
+
+// A uniform random cost of 0, ..., maxValue
+unsigned long long int Generator::randomCost() {
+  return std::uniform_int_distribution<unsigned long long int>(0, maxValue)(random);
+}
+
+// A uniform random capacity of 1, ..., maxValue
+unsigned long long int Generator::randomCapacity() {
+  return std::uniform_int_distribution<unsigned long long int>(1, maxValue)(random);
+}
+
+// A uniform random permutation of 0, ..., count-1
+std::vector<unsigned int> Generator::randomPermutation(unsigned int count) {
+  std::vector<unsigned int> permutation(count);
+  std::iota(permutation.begin(), permutation.end(), 0);
+  std::shuffle(permutation.begin(), permutation.end(), random);
+  return permutation;
+}
+
+// Random connected graph with 8 edges per node
+void Generator::mstRandom(unsigned long long int edgeCount) {
+  unsigned int n = checkNodeCount(std::max(2ULL, edgeCount / 8));
+  writeHeader(n);
+
+  // Random tree, every node is attached to a random earlier node of the
+  // permutation
+  std::vector<unsigned int> order = randomPermutation(n);
+  for (unsigned int i = 1; i < n; i++) {
+    writeEdge(order[i], order[randomNode(i)], randomCost());
+  }
+  order = std::vector<unsigned int>();
+
+  for (unsigned long long int e = n - 1; e < edgeCount; e++) {
+    unsigned int a = randomNode(n);
+    unsigned int b = randomNode(n - 1);
+    // no loops
+    if (b >= a) {
+      b++;
+    }
+    writeEdge(a, b, randomCost());
+  }
+}
+
+// Grid graph with 2 edges per node
+void Generator::mstGrid(unsigned long long int edgeCount) {
+  unsigned long long int width = std::max(2ULL, static_cast<unsigned long long int>(std::sqrt(edgeCount / 2.0)));
+  unsigned long long int height = std::max(2ULL, edgeCount / (2 * width));
+  checkNodeCount(width * height);
+  writeHeader(width * height);
+
+  for (unsigned int y = 0; y < height; y++) {
+    for (unsigned int x = 0; x < width; x++) {
+      unsigned int a = y * width + x;
+      if (x + 1 < width) {
+        writeEdge(a, a + 1, randomCost());
+      }
+      if (y + 1 < height) {
+        writeEdge(a, a + width, randomCost());
+      }
+    }
+  }
+}
+
+// RMAT graph with 8 edges per node, the probabilities of the quadrants are
+// 0.57, 0.19, 0.19 and 0.05
+void Generator::flowRmat(unsigned long long int edgeCount) {
+  unsigned int scale = 2;
+  while ((1ULL << scale) < edgeCount / 8) {
+    scale++;
+  }
+  unsigned int n = checkNodeCount(1ULL << scale);
+  writeHeader(n);
+
+  std::uniform_real_distribution<double> uniform(0, 1);
+  for (unsigned long long int e = 0; e < edgeCount; e++) {
+    unsigned int a;
+    unsigned int b;
+    do {
+      a = 0;
+      b = 0;
+      for (unsigned int bit = 0; bit < scale; bit++) {
+        double r = uniform(random);
+        if (r >= 0.57) {
+          if (r < 0.76) {
+            b |= 1u << bit;
+          } else if (r < 0.95) {
+            a |= 1u << bit;
+          } else {
+            a |= 1u << bit;
+            b |= 1u << bit;
+          }
+        }
+      }
+    } while (a == b);
+    writeEdge(a, b, randomCapacity());
+  }
+}
+
+// Layered network, the layers are about as wide as they are many
+void Generator::flowLayered(unsigned long long int edgeCount, unsigned int degree) {
+  degree = std::max(1u, degree);
+  unsigned long long int width = std::max(1ULL, static_cast<unsigned long long int>(std::sqrt(edgeCount / static_cast<double>(degree))));
+  unsigned long long int layers = std::max(1ULL, edgeCount / (degree * width));
+  checkNodeCount(2 + width * layers);
+  writeHeader(2 + width * layers);
+
+  // the nodes of layer l are 2 + l*width, ..., 2 + (l+1)*width - 1
+  for (unsigned int i = 0; i < width; i++) {
+    writeEdge(0, 2 + i, randomCapacity());
+  }
+  for (unsigned int l = 0; l + 1 < layers; l++) {
+    for (unsigned int i = 0; i < width; i++) {
+      for (unsigned int k = 0; k < degree; k++) {
+        writeEdge(2 + l * width + i, 2 + (l + 1) * width + randomNode(width), randomCapacity());
+      }
+    }
+  }
+  for (unsigned int i = 0; i < width; i++) {
+    writeEdge(2 + (layers - 1) * width + i, 1, randomCapacity());
+  }
+}
+
+// Square grid with edges to all four neighbours
+void Generator::flowGrid(unsigned long long int edgeCount) {
+  unsigned long long int side = std::max(2ULL, static_cast<unsigned long long int>(std::sqrt(edgeCount / 4.0)));
+  checkNodeCount(2 + side * side);
+  writeHeader(2 + side * side);
+
+  // the node in column x and row y is 2 + y*side + x
+  for (unsigned int y = 0; y < side; y++) {
+    writeEdge(0, 2 + y * side, randomCapacity());
+    for (unsigned int x = 0; x < side; x++) {
+      unsigned int a = 2 + y * side + x;
+      if (x + 1 < side) {
+        writeEdge(a, a + 1, randomCapacity());
+      }
+      if (x > 0) {
+        writeEdge(a, a - 1, randomCapacity());
+      }
+      if (y + 1 < side) {
+        writeEdge(a, a + side, randomCapacity());
+      }
+      if (y > 0) {
+        writeEdge(a, a - side, randomCapacity());
+      }
+    }
+    writeEdge(2 + y * side + side - 1, 1, randomCapacity());
+  }
+}
+
+// Complete bipartite graph
+void Generator::matchingDense(unsigned long long int edgeCount) {
+  unsigned long long int half = std::max(1ULL, static_cast<unsigned long long int>(std::sqrt(static_cast<double>(edgeCount))));
+  checkNodeCount(2 * half);
+  writeHeader(2 * half);
+
+  for (unsigned int i = 0; i < half; i++) {
+    for (unsigned int j = 0; j < half; j++) {
+      writeEdge(i, half + j, randomCost());
+    }
+  }
+}
+
+// Sparse bipartite graph with a perfect matching
+void Generator::matchingSparse(unsigned long long int edgeCount, unsigned int degree) {
+  degree = std::max(1u, degree);
+  unsigned long long int half = std::max(1ULL, edgeCount / degree);
+  checkNodeCount(2 * half);
+  writeHeader(2 * half);
+
+  std::vector<unsigned int> partner = randomPermutation(half);
+  for (unsigned int i = 0; i < half; i++) {
+    writeEdge(i, half + partner[i], randomCost());
+    for (unsigned int k = 1; k < degree; k++) {
+      writeEdge(i, half + randomNode(half), randomCost());
+    }
+  }
+}
@@ -0,0 +1,55 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <random>
+#include <vector>
+#include <iostream>
+#include "Writer.h"
+
+// Writes random instances in the formats of the exercises: a line with the
+// node count, then one line "a b value" per edge. The instances have about
+// the requested number of edges, the values are uniform in [0, maxValue]
+// (capacities in [1, maxValue]). Equal seeds give equal instances.
+//
+// The edges are written while they are generated, only permutations of the
+// nodes are kept in memory.
+class Generator {
+public:
+  Generator(std::ostream& out, unsigned long long int seed, unsigned long long int maxValue);
+
+  // Minimum spanning tree instances: a random tree plus random edges (8
+  // edges per node) resp. a grid with edges to the right and lower
+  // neighbours. Both are connected.
+  void mstRandom(unsigned long long int edgeCount);
+  void mstGrid(unsigned long long int edgeCount);
+
+  // Flow networks with source 0 and sink 1. RMAT: edges are placed by
+  // choosing one quadrant of the adjacency matrix per bit of the node ids,
+  // which gives a skewed degree distribution. Layered: s, layers of equal
+  // width with degree edges from every node into the next layer, t. Grid: a
+  // grid with edges to all four neighbours, s before the first and t after
+  // the last column.
+  void flowRmat(unsigned long long int edgeCount);
+  void flowLayered(unsigned long long int edgeCount, unsigned int degree);
+  void flowGrid(unsigned long long int edgeCount);
+
+  // Bipartite matching instances with the left nodes 0, ..., n/2-1. Dense:
+  // all edges between the partitions. Sparse: degree edges per left node,
+  // one of them along a random perfect matching, so that there is one.
+  void matchingDense(unsigned long long int edgeCount);
+  void matchingSparse(unsigned long long int edgeCount, unsigned int degree);
+private:
+  unsigned int checkNodeCount(unsigned long long int nodeCount);
+  void writeHeader(unsigned int nodeCount);
+  void writeEdge(unsigned int a, unsigned int b, unsigned long long int value);
+  unsigned int randomNode(unsigned int count);
+  unsigned long long int randomCost();
+  unsigned long long int randomCapacity();
+  std::vector<unsigned int> randomPermutation(unsigned int count);
+
+  std::mt19937_64 random;
+  Writer w;
+  unsigned long long int maxValue;
+};
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Generator of random instances for the three exercises
+ * Requires c++11 standard for compiling
+ *
+ * Usage: main <type> <edge count> [-s seed] [-c max value] [-d degree] [-o file]
+ *
+ * Types: mst-random, mst-grid (Blatt 1), flow-rmat, flow-layered, flow-grid
+ * (Blatt 2, source 0 and sink 1), matching-dense, matching-sparse (Blatt 3).
+ * The instance is written to standard output if no file is given.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include "Generator.h"
+
+// Command line options
+struct Options {
+  std::string type = "";
+  unsigned long long int edgeCount = 0;
+  unsigned long long int seed = 1;
+  unsigned long long int maxValue = 1000;
+  // edges per node of flow-layered and matching-sparse
+  unsigned int degree = 0;
+  std::string outputfile = "";
+  bool outputfileSpecified = false;
+};
+
+// Writes the instance of the options
+bool generate(Generator& g, Options& o) {
+  if (o.type == "mst-random") {
+    g.mstRandom(o.edgeCount);
+  } else if (o.type == "mst-grid") {
+    g.mstGrid(o.edgeCount);
+  } else if (o.type == "flow-rmat") {
+    g.flowRmat(o.edgeCount);
+  } else if (o.type == "flow-layered") {
+    g.flowLayered(o.edgeCount, o.degree == 0 ? 4 : o.degree);
+  } else if (o.type == "flow-grid") {
+    g.flowGrid(o.edgeCount);
+  } else if (o.type == "matching-dense") {
+    g.matchingDense(o.edgeCount);
+  } else if (o.type == "matching-sparse") {
+    g.matchingSparse(o.edgeCount, o.degree == 0 ? 8 : o.degree);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Main function
+int main(int argc, char** argv) {
+  Options o;
+  unsigned int positional = 0;
+  for (int i=1; i<argc; i++) {
+    if (argv[i][0] == '-') {
+      if (argv[i][1] == 's') {
+        // Seed of the random numbers
+        if (i+1 < argc) {
+          try {
+            o.seed = std::stoull(argv[i+1]);
+          } catch (std::logic_error&) {
+            std::cout << "Invalid seed " << argv[i+1] << "." << '\n';
+            return 0;
+          }
+          i++;
+        }
+      } else if (argv[i][1] == 'c') {
+        // Largest cost resp. capacity
+        if (i+1 < argc) {
+          try {
+            o.maxValue = std::stoull(argv[i+1]);
+          } catch (std::logic_error&) {
+            std::cout << "Invalid largest value " << argv[i+1] << "." << '\n';
+            return 0;
+          }
+          i++;
+        }
+      } else if (argv[i][1] == 'd') {
+        // Edges per node
+        if (i+1 < argc) {
+          try {
+            o.degree = std::stoul(argv[i+1]);
+          } catch (std::logic_error&) {
+            std::cout << "Invalid degree " << argv[i+1] << "." << '\n';
+            return 0;
+          }
+          i++;
+        }
+      } else if (argv[i][1] == 'o') {
+        // Output file can be specified
+        if (i+1 < argc) {
+          o.outputfile = std::string(argv[i+1]);
+          o.outputfileSpecified = true;
+          i++;
+        }
+      }
+    } else if (positional == 0) {
+      o.type = argv[i];
+      positional++;
+    } else {
+      // the edge count may be given as 1e6
+      try {
+        o.edgeCount = static_cast<unsigned long long int>(std::stod(argv[i]));
+      } catch (std::logic_error&) {
+        std::cout << "Invalid edge count " << argv[i] << "." << '\n';
+        return 0;
+      }
+      positional++;
+    }
+  }
+
+  if (positional < 2 || o.edgeCount == 0) {
+    std::cout << "Please specify the instance type and the edge count." << '\n';
+    return 0;
+  }
+
+  bool known;
+  if (o.outputfileSpecified) {
+    std::fstream file(o.outputfile, std::ios_base::out);
+    Generator g(file, o.seed, o.maxValue);
+    known = generate(g, o);
+  } else {
+    Generator g(std::cout, o.seed, o.maxValue);
+    known = generate(g, o);
+  }
+  if (!known) {
+    std::cout << "Unknown instance type " << o.type << "." << '\n';
+  }
+
+  return 0;
+}